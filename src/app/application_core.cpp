@@ -8,11 +8,21 @@
 #include "application_private.hpp"
 
 #include "layout_debug.hpp"
+#include "skin.hpp"
 #include "skin_manager.hpp"
 
 void ApplicationPrivate::initCore()
 {
   _time_src = std::make_unique<TimeSource>();
+  // tick only as often as displayed content can change
+  _time_src->setIntervalProvider([this]() {
+    using namespace std::chrono_literals;
+    TimeSource::Interval interval = 1min;
+    for (const auto& wnd : std::as_const(_windows))
+      if (auto skin = wnd->skin())
+        interval = std::min(interval, skin->updateInterval());
+    return interval;
+  });
   _skin_manager = std::make_unique<SkinManagerImpl>(this);
   if (_app_config->global().getChangeOpacityOnMouseHover())
     _mouse_tracker = std::make_unique<MouseTracker>();
@@ -42,11 +52,10 @@ void ApplicationPrivate::initUpdater()
 void ApplicationPrivate::applyDebugOptions()
 {
   if (_app_config->global().getEnableDebugOptions()) {
-    qputenv(debug::ItemDebugFlagsVar, QByteArray::number(_app_config->debug().getItemDebugFlags()));
-    qputenv(debug::LayoutDebugFlagsVar, QByteArray::number(_app_config->debug().getLayoutDebugFlags()));
+    debug::setLayoutDebugFlags(_app_config->debug().getItemDebugFlags(),
+                               _app_config->debug().getLayoutDebugFlags());
   } else {
-    qunsetenv(debug::ItemDebugFlagsVar);
-    qunsetenv(debug::LayoutDebugFlagsVar);
+    debug::setLayoutDebugFlags({}, {});
   }
 }
 
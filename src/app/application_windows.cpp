@@ -11,7 +11,6 @@
 #include <utility>
 
 #include <QGraphicsEffect>
-#include <QPixmapCache>
 
 #include "window_state.hpp"
 
@@ -33,6 +32,7 @@ void ApplicationPrivate::configureWindow(ClockWindow* wnd)
   wnd->setSnapThreshold(_app_config->global().getSnapThreshold());
   wnd->changeOpacityOnMouseHover(_app_config->global().getChangeOpacityOnMouseHover());
   wnd->setOpacityOnMouseHover(_app_config->global().getOpacityOnMouseHover());
+  wnd->setRenderAhead(_app_config->global().getRenderAhead());
   if (!_app_config->window(widx).general().getShowLocalTime())
     wnd->setTimeZone(_app_config->window(widx).state().getTimeZone());
   wnd->setWindowOpacity(cfg.appearance().getOpacity());
@@ -72,6 +72,7 @@ void ApplicationPrivate::createWindow(const QScreen* screen)
   wnd->setWindowFlag(Qt::Tool);   // trick to hide app icon from taskbar (Windows only)
 #endif
   connect(_time_src.get(), &TimeSource::timeChanged, wnd.get(), &ClockWindow::setDateTime);
+  connect(wnd.get(), &ClockWindow::updateIntervalChanged, _time_src.get(), &TimeSource::reschedule);
   if (_windows.empty() || _app_config->global().getConfigPerWindow())
     connect(_time_src.get(), &TimeSource::timeChanged, wnd.get(), &ClockWindow::animateSeparator);
   if (_mouse_tracker && _app_config->global().getChangeOpacityOnMouseHover())
@@ -87,8 +88,5 @@ void Application::createWindows()
     connect(wnd.get(), &ClockWindow::aboutDialogRequested, this, &Application::showAboutDialog);
     connect(wnd.get(), &ClockWindow::appExitRequested, this, &Application::quit);
   }
-  // TODO: change pixmap cache size depending on scaling
-  // for "common" (because cache is shared) 16 MB + 16 MB per window
-  QPixmapCache::setCacheLimit((1 + _impl->windows().size()) * 16 * 1024);
   std::ranges::for_each(_impl->windows(), [](auto&& wnd) { wnd->show(); });
 }
@@ -6,16 +6,66 @@
 
 #include "clock_widget.hpp"
 
+#include <QGuiApplication>
 #include <QPainter>
 #include <QPaintEvent>
-#include <QPixmapCache>
+#include <QThreadPool>
 
+#include <utility>
+
+#include "display_list.hpp"
+#include "glyph_cache.hpp"
 #include "skin.hpp"
 
+namespace {
+
+// all offscreen rendering happens in this single thread, so resources
+// (which are not thread-safe) are never drawn concurrently
+QThreadPool* renderPool()
+{
+  static QThreadPool* pool = [] {
+    auto pool = new QThreadPool(qApp);
+    pool->setMaxThreadCount(1);
+    return pool;
+  }();
+  return pool;
+}
+
+void setupPainter(QPainter* p)
+{
+  p->setRenderHint(QPainter::Antialiasing);
+  p->setRenderHint(QPainter::SmoothPixmapTransform);
+}
+
+QImage renderFrame(Resource& res, qreal kx, qreal ky, qreal dpr)
+{
+  const auto r = res.rect();
+  QImage img((QSizeF(kx * r.width(), ky * r.height()) * dpr).toSize(),
+             QImage::Format_ARGB32_Premultiplied);
+  img.setDevicePixelRatio(dpr);
+  img.fill(Qt::transparent);
+  QPainter p(&img);
+  setupPainter(&p);
+  p.scale(kx, ky);
+  p.translate(-r.topLeft());
+  res.draw(&p);
+  return img;
+}
+
+// the start of the interval containing given time, or the next one
+QDateTime intervalStart(const QDateTime& dt, std::chrono::milliseconds interval, int n = 0)
+{
+  const auto ms = dt.toMSecsSinceEpoch();
+  const auto i = std::max<qint64>(interval.count(), 1);
+  return QDateTime::fromMSecsSinceEpoch(ms - ms % i + n * i).toUTC();
+}
+
+} // namespace
+
 class ClockWidgetImpl : public SkinObserver,
                         public std::enable_shared_from_this<ClockWidgetImpl> {
 public:
-  ClockWidgetImpl(QWidget* w, const QDateTime& dt)
+  ClockWidgetImpl(ClockWidget* w, const QDateTime& dt)
       : _widget(w)
       , _dt(dt.toUTC())
       , _tz(dt.timeZone())
@@ -24,12 +74,21 @@ public:
     Q_ASSERT(_widget);
   }
 
+  ~ClockWidgetImpl()
+  {
+    // resources may refer to the skin
+    if (_render_ahead) renderPool()->waitForDone();
+  }
+
   void setSkin(std::shared_ptr<Skin> skin)
   {
+    if (_render_ahead) renderPool()->waitForDone();
     _skin = std::move(skin);
     if (_skin) _skin->addObserver(weak_from_this());
     _glyph.reset();
+    _list = {};
     update();
+    emit _widget->updateIntervalChanged();
   }
 
   std::shared_ptr<Skin> skin() const { return _skin; }
@@ -37,7 +96,10 @@ public:
   void setDateTime(const QDateTime& dt)
   {
     _dt = dt.toUTC();
-    update();
+    if (_render_ahead)
+      presentAhead();
+    else
+      updateChanged();
   }
 
   void setTimeZone(const QTimeZone& tz)
@@ -49,7 +111,27 @@ public:
   void animateSeparator()
   {
     if (!_skin) return;
+    if (_render_ahead) {
+      // the next frame must be rendered with new separator state
+      renderPool()->waitForDone();
+      _skin->animateSeparator();
+      _ahead.reset();
+      scheduleAhead();
+      return;
+    }
     _skin->animateSeparator();
+    updateChanged();
+  }
+
+  // skin is processed and rendered for the next tick in advance,
+  // so only a ready image is drawn when the tick arrives
+  void setRenderAheadEnabled(bool enable)
+  {
+    if (_render_ahead == enable) return;
+    renderPool()->waitForDone();
+    _render_ahead = enable;
+    _ahead.reset();
+    _shown = {};
     update();
   }
 
@@ -62,6 +144,10 @@ public:
 
   QSizeF size() const
   {
+    if (_render_ahead && !_shown.image.isNull()) {
+      auto s = _shown.rect.size();
+      return {_kx * s.width(), _ky * s.height()};
+    }
     if (!_glyph) return {400., 150.};
     auto s = _glyph->rect().size();
     return {_kx * s.width(), _ky * s.height()};
@@ -73,41 +159,166 @@ public:
     // so drop cache on system theme change (e.g. light/dark)
     if (_widget->palette() != _last_palette) {
       _last_palette = _widget->palette();
-      QPixmapCache::clear();
+      GlyphCache::clearAll();
+    }
+    if (_render_ahead) {
+      p->drawImage(QPointF(0, 0), _shown.image);
+      return;
     }
     if (!_glyph) return;
-    p->setRenderHint(QPainter::Antialiasing);
-    p->setRenderHint(QPainter::SmoothPixmapTransform);
-    p->scale(_kx, _ky);
-    p->translate(-_glyph->rect().topLeft());
-    _glyph->draw(p);
+    setupPainter(p);
+    p->setTransform(resourceTransform(), true);
+    _list.replay(p);
   }
 
-  void onConfigurationChanged() override { update(); }
+  void onConfigurationChanged() override
+  {
+    update();
+    emit _widget->updateIntervalChanged();
+  }
 
 private:
+  // frame rendered in advance
+  struct RenderedFrame {
+    QImage image;
+    std::shared_ptr<Resource> res;
+    QRectF rect;      // resource rect
+    QDateTime dt;     // time it was rendered for (UTC)
+  };
+
   void update()
   {
     if (!_skin) return;
+    if (_render_ahead) {
+      renderPool()->waitForDone();
+      _ahead.reset();
+      renderNow();
+      scheduleAhead();
+      return;
+    }
     _glyph = _skin->process(_dt.toTimeZone(_tz));
+    _list = DisplayList::record(_glyph);
     _widget->updateGeometry();
     _widget->update();
   }
 
+  // repaints only area reported as changed by the skin, if the skin
+  // can't tell it, the area is found by comparing recorded display lists
+  void updateChanged()
+  {
+    if (!_skin) return;
+    const auto last_rect = _glyph ? _glyph->rect() : QRectF();
+    _glyph = _skin->process(_dt.toTimeZone(_tz));
+
+    // the same resource is returned for the same time, nothing to re-record
+    if (_list.isRecordedFrom(_glyph) && _glyph->rect() == last_rect)
+      return;
+
+    const auto prev = std::exchange(_list, DisplayList::record(_glyph));
+    if (_glyph->rect() != last_rect) {
+      _widget->updateGeometry();
+      _widget->update();
+      return;
+    }
+
+    auto changed = _skin->changedRect();
+    if (!changed) changed = prev.diff(_list);
+    if (changed->isEmpty())
+      return;
+
+    // extra pixel around for antialiasing
+    auto r = resourceTransform().mapRect(*changed).toAlignedRect();
+    _widget->update(QRegion(r.adjusted(-1, -1, 1, 1)));
+  }
+
+  void presentAhead()
+  {
+    if (!_skin) return;
+    // frame is accessed only when rendering thread is idle
+    renderPool()->waitForDone();
+    if (_ahead && _ahead->dt == intervalStart(_dt, _skin->updateInterval()))
+      present(std::move(*_ahead));
+    else
+      renderNow();    // missed, tick is not aligned, or something has changed
+    _ahead.reset();
+    scheduleAhead();
+  }
+
+  void present(RenderedFrame frame)
+  {
+    const bool resized = frame.rect.size() != _shown.rect.size();
+    _shown = std::move(frame);
+    _glyph = _shown.res;    // always what is shown
+    if (resized) _widget->updateGeometry();
+    _widget->update();
+  }
+
+  // synchronous fallback, rendering thread must be idle
+  void renderNow()
+  {
+    auto res = _skin->process(_dt.toTimeZone(_tz));
+    auto img = renderFrame(*res, _kx, _ky, _widget->devicePixelRatioF());
+    const auto r = res->rect();
+    present({std::move(img), std::move(res), r, _dt});
+  }
+
+  // several requests during one event loop iteration are merged
+  void scheduleAhead()
+  {
+    if (_ahead_scheduled) return;
+    _ahead_scheduled = true;
+    QMetaObject::invokeMethod(_widget, [w = weak_from_this()]() {
+      if (auto d = w.lock()) d->renderAhead();
+    }, Qt::QueuedConnection);
+  }
+
+  // both skin processing and rasterization happen in rendering thread,
+  // GUI thread touches the skin only when that thread is idle
+  void renderAhead()
+  {
+    _ahead_scheduled = false;
+    if (!_render_ahead || !_skin) return;
+    // the skin may be in use by previous job (maybe for other window)
+    renderPool()->waitForDone();
+    auto frame = std::make_shared<RenderedFrame>();
+    frame->dt = intervalStart(_dt, _skin->updateInterval(), 1);
+    _ahead = frame;
+    renderPool()->start([frame, skin = _skin, tz = _tz, kx = _kx, ky = _ky, dpr = _widget->devicePixelRatioF()]() {
+      frame->res = skin->process(frame->dt.toTimeZone(tz));
+      frame->rect = frame->res->rect();
+      frame->image = renderFrame(*frame->res, kx, ky, dpr);
+    });
+  }
+
+  // maps resource coordinates to widget coordinates
+  QTransform resourceTransform() const
+  {
+    QTransform t;
+    t.scale(_kx, _ky);
+    if (_glyph) t.translate(-_glyph->rect().left(), -_glyph->rect().top());
+    return t;
+  }
+
 private:
-  QWidget* _widget;
+  ClockWidget* _widget;
   std::shared_ptr<Skin> _skin;
   std::shared_ptr<Resource> _glyph;
+  DisplayList _list;        // recorded _glyph, not used in render-ahead mode
   QDateTime _dt;
   QTimeZone _tz;
   qreal _kx = 1;
   qreal _ky = 1;
   QPalette _last_palette;   // used just to detect theme changes
+  // render-ahead mode
+  bool _render_ahead = false;
+  bool _ahead_scheduled = false;
+  RenderedFrame _shown;
+  std::shared_ptr<RenderedFrame> _ahead;
 };
 
 
 struct ClockWidget::impl {
-  impl(QWidget* w)
+  impl(ClockWidget* w)
       : d(std::make_shared<ClockWidgetImpl>(w, QDateTime::currentDateTime()))
   {}
 
@@ -163,6 +374,16 @@ void ClockWidget::scale(qreal kx, qreal ky)
   _impl->d->scale(kx, ky);
 }
 
+void ClockWidget::setRenderAheadEnabled(bool enable)
+{
+  _impl->d->setRenderAheadEnabled(enable);
+}
+
+void ClockWidget::waitForRendering()
+{
+  renderPool()->waitForDone();
+}
+
 void ClockWidget::paintEvent(QPaintEvent* event)
 {
   QPainter p(this);
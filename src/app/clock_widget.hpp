@@ -39,6 +39,18 @@ public slots:
 
   void scale(qreal kx, qreal ky);
 
+  // render next frame in background thread in advance
+  void setRenderAheadEnabled(bool enable);
+
+public:
+  // skins are processed in background thread in render-ahead mode,
+  // so this must be called before any skin modification
+  static void waitForRendering();
+
+signals:
+  // skin or its configuration is changed, so is its update interval
+  void updateIntervalChanged();
+
 protected:
   void paintEvent(QPaintEvent* event) override;
 
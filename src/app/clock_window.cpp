@@ -42,6 +42,7 @@ ClockWindow::ClockWindow(StatePtr state, QWidget* parent)
   _impl->clock_widget = new ClockWidget(this);
   // clock widget supports resize and fills all available space by default
   _impl->clock_widget->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+  connect(_impl->clock_widget, &ClockWidget::updateIntervalChanged, this, &ClockWindow::updateIntervalChanged);
   _impl->main_layout = new QGridLayout(this);
   _impl->main_layout->setContentsMargins(0, 0, 0, 0);
   _impl->main_layout->addWidget(_impl->clock_widget);
@@ -80,6 +81,7 @@ bool ClockWindow::isSeparatorFlashes() const
 void ClockWindow::setSkin(std::shared_ptr<Skin> skin)
 {
   if (skin) {
+    ClockWidget::waitForRendering();   // the skin may be shared
     skin->setSeparatorAnimationEnabled(_impl->separator_flashes);
   }
   _impl->clock_widget->setSkin(std::move(skin));
@@ -103,8 +105,10 @@ void ClockWindow::setTimeZone(const QTimeZone& tz)
 void ClockWindow::setSeparatorFlashes(bool flashes)
 {
   _impl->separator_flashes = flashes;
+  ClockWidget::waitForRendering();
   _impl->clock_widget->skin()->setSeparatorAnimationEnabled(flashes);
   update();
+  emit updateIntervalChanged();
 }
 
 void ClockWindow::animateSeparator()
@@ -117,6 +121,11 @@ void ClockWindow::scale(int sx, int sy)
   _impl->clock_widget->scale(sx / 100., sy / 100.);
 }
 
+void ClockWindow::setRenderAhead(bool enable)
+{
+  _impl->clock_widget->setRenderAheadEnabled(enable);
+}
+
 void ClockWindow::setAlignment(Qt::Alignment alignment)
 {
   if (_impl->alignment == alignment)
@@ -50,6 +50,8 @@ signals:
   void settingsDialogRequested();
   void aboutDialogRequested();
   void appExitRequested();
+  // displayed content may change more or less often now
+  void updateIntervalChanged();
 
 public slots:
   void setDateTime(const QDateTime& utc);
@@ -61,6 +63,8 @@ public slots:
 
   void scale(int sx, int sy); // in percents
 
+  void setRenderAhead(bool enable);
+
   void setAlignment(Qt::Alignment alignment);
 
   void setSnapToEdge(bool enable);
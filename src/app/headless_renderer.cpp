@@ -0,0 +1,293 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "headless_renderer.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QPainter>
+#include <QRegularExpression>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include "classic_skin.hpp"
+#include "skin_manager.hpp"
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace {
+
+// any of these options turns headless mode on
+constexpr const char* headless_options[] = {"--render-to", "--list-skins"};
+
+// frames rendered but not written yet, limits memory usage
+// when rendering is faster than encoding
+constexpr int max_queued_frames = 8;
+
+struct HeadlessOptions {
+  QString output;
+  QString skin;
+  QFont font;
+  QString format;
+  QDateTime time;
+  int frames = 1;
+  qreal fps = 1.0;
+  qreal scale = 1.0;
+  bool list_skins = false;
+};
+
+class HeadlessSkinConfigurator final : public SkinVisitor
+{
+public:
+  explicit HeadlessSkinConfigurator(const HeadlessOptions& opts) noexcept
+    : _opts(opts)
+  {}
+
+  void visit(ClassicSkin* skin) override
+  {
+    if (!_opts.format.isEmpty())
+      skin->setFormat(_opts.format);
+  }
+
+  void visit(ErrorSkin* skin) noexcept override { Q_UNUSED(skin); }
+  void visit(ModernSkin* skin) noexcept override { Q_UNUSED(skin); }
+
+private:
+  const HeadlessOptions& _opts;
+};
+
+// writes frames in a separate thread, in the same order as they were added
+class FrameWriter final
+{
+public:
+  FrameWriter(QString output, int frames)
+    : _output(std::move(output))
+    , _frames(frames)
+  {
+    _pool.setMaxThreadCount(1);
+    if (isStream()) {
+      if (!_stream.open(stdout, QIODevice::WriteOnly | QIODevice::Unbuffered))
+        _ok = false;
+    }
+  }
+
+  ~FrameWriter() { _pool.waitForDone(); }
+
+  bool isStream() const noexcept { return _output == u"-"_s; }
+  bool ok() const noexcept { return _ok; }
+
+  void write(QImage img, int index)
+  {
+    _slots.acquire();
+    _pool.start([this, img = std::move(img), index]() {
+      if (_ok && !(isStream() ? writeRaw(img) : img.save(fileName(index)))) {
+        qCritical("failed to write frame %d", index);
+        _ok = false;
+      }
+      _slots.release();
+    });
+  }
+
+  void waitForDone() { _pool.waitForDone(); }
+
+private:
+  // raw RGBA frames, one after another
+  bool writeRaw(const QImage& img)
+  {
+    const auto raw = img.convertToFormat(QImage::Format_RGBA8888);
+    const auto line_size = raw.width() * 4;
+    for (int y = 0; y < raw.height(); y++)
+      if (_stream.write(reinterpret_cast<const char*>(raw.constScanLine(y)), line_size) != line_size)
+        return false;
+    return true;
+  }
+
+  // '#' characters sequence is replaced by zero-padded frame number,
+  // if there is no such sequence, number is appended to the base name
+  QString fileName(int index) const
+  {
+    if (_frames == 1)
+      return _output;
+
+    static const QRegularExpression placeholder(u"#+"_s);
+    if (auto m = placeholder.match(_output); m.hasMatch()) {
+      QString name = _output;
+      return name.replace(m.capturedStart(), m.capturedLength(),
+                          u"%1"_s.arg(index, m.capturedLength(), 10, QChar(u'0')));
+    }
+
+    QFileInfo fi(_output);
+    const auto name = u"%1_%2"_s.arg(fi.completeBaseName()).arg(index, 6, 10, QChar(u'0'));
+    return fi.dir().filePath(fi.suffix().isEmpty() ? name : name + u'.' + fi.suffix());
+  }
+
+private:
+  const QString _output;
+  const int _frames;
+  QThreadPool _pool;
+  QSemaphore _slots{max_queued_frames};
+  QFile _stream;
+  std::atomic_bool _ok = true;
+};
+
+// canvas (in device pixels) is used to keep frames size constant,
+// frame is drawn at its top left corner, invalid size means "fit to frame"
+QImage renderFrame(Resource& res, qreal dpr, QSize canvas)
+{
+  const auto r = res.rect();
+  QImage img(canvas.isValid() ? canvas : (r.size() * dpr).toSize(),
+             QImage::Format_ARGB32_Premultiplied);
+  img.setDevicePixelRatio(dpr);
+  img.fill(Qt::transparent);
+  QPainter p(&img);
+  p.setRenderHint(QPainter::Antialiasing);
+  p.setRenderHint(QPainter::SmoothPixmapTransform);
+  p.translate(-r.topLeft());
+  res.draw(&p);
+  return img;
+}
+
+std::optional<HeadlessOptions> parseOptions(const QStringList& args)
+{
+  QCommandLineParser parser;
+  parser.setApplicationDescription(u"Renders clock without any windows."_s);
+  parser.addHelpOption();
+  QCommandLineOption render_to_opt(u"render-to"_s,
+      u"Output image file, '#' characters are replaced by frame number, '-' means raw RGBA frames to stdout."_s,
+      u"file"_s);
+  QCommandLineOption skin_opt(u"skin"_s, u"Skin name, font is used if not set."_s, u"name"_s);
+  QCommandLineOption font_opt(u"font"_s, u"Font to use instead of skin, in QFont::toString() form."_s, u"font"_s);
+  QCommandLineOption format_opt(u"format"_s, u"Time format (classic skins only)."_s, u"format"_s);
+  QCommandLineOption time_opt(u"time"_s, u"Time of the first frame (ISO 8601), current time by default."_s, u"time"_s);
+  QCommandLineOption frames_opt(u"frames"_s, u"Number of frames to render."_s, u"N"_s, u"1"_s);
+  QCommandLineOption fps_opt(u"fps"_s, u"Frames per second (of clock time, not real time)."_s, u"F"_s, u"1"_s);
+  QCommandLineOption scale_opt(u"scale"_s, u"Device pixel ratio."_s, u"dpr"_s, u"1"_s);
+  QCommandLineOption list_opt(u"list-skins"_s, u"Print available skins and exit."_s);
+  parser.addOptions({render_to_opt, skin_opt, font_opt, format_opt, time_opt,
+                     frames_opt, fps_opt, scale_opt, list_opt});
+  parser.process(args);
+
+  HeadlessOptions opts;
+  opts.output = parser.value(render_to_opt);
+  opts.skin = parser.value(skin_opt);
+  opts.format = parser.value(format_opt);
+  opts.list_skins = parser.isSet(list_opt);
+
+  if (opts.output.isEmpty() && !opts.list_skins) {
+    qCritical("no output file specified");
+    return std::nullopt;
+  }
+
+  if (parser.isSet(font_opt) && !opts.font.fromString(parser.value(font_opt))) {
+    qCritical("invalid font: %s", qUtf8Printable(parser.value(font_opt)));
+    return std::nullopt;
+  }
+
+  opts.time = parser.isSet(time_opt)
+              ? QDateTime::fromString(parser.value(time_opt), Qt::ISODate)
+              : QDateTime::currentDateTime();
+  if (!opts.time.isValid()) {
+    qCritical("invalid time: %s", qUtf8Printable(parser.value(time_opt)));
+    return std::nullopt;
+  }
+
+  bool ok_frames = false, ok_fps = false, ok_scale = false;
+  opts.frames = parser.value(frames_opt).toInt(&ok_frames);
+  opts.fps = parser.value(fps_opt).toDouble(&ok_fps);
+  opts.scale = parser.value(scale_opt).toDouble(&ok_scale);
+  if (!ok_frames || opts.frames < 1 || !ok_fps || opts.fps <= 0 || !ok_scale || opts.scale <= 0) {
+    qCritical("invalid --frames, --fps or --scale value");
+    return std::nullopt;
+  }
+
+  return opts;
+}
+
+} // namespace
+
+bool isHeadlessMode(int argc, char** argv)
+{
+  for (int i = 1; i < argc; i++)
+    for (auto opt : headless_options)
+      // also matches "--option=value" form
+      if (std::strncmp(argv[i], opt, std::strlen(opt)) == 0)
+        return true;
+  return false;
+}
+
+int runHeadless(int argc, char** argv)
+{
+  // no display is required
+  if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  QApplication app(argc, argv);
+
+  auto opts = parseOptions(app.arguments());
+  if (!opts)
+    return 1;
+
+  // skin manager needs no app internals to find and load skins
+  SkinManagerImpl skin_manager(nullptr);
+
+  if (opts->list_skins) {
+    for (const auto& name : skin_manager.availableSkins())
+      std::printf("%s\n", qUtf8Printable(name));
+    return 0;
+  }
+
+  if (!opts->skin.isEmpty() && !skin_manager.availableSkins().contains(opts->skin)) {
+    qCritical("unknown skin: %s", qUtf8Printable(opts->skin));
+    return 1;
+  }
+
+  auto skin = opts->skin.isEmpty()
+              ? skin_manager.loadSkin(opts->font)
+              : skin_manager.loadSkin(opts->skin);
+  HeadlessSkinConfigurator configurator(*opts);
+  skin->visit(configurator);
+  skin->setSeparatorAnimationEnabled(opts->frames > 1);
+
+  FrameWriter writer(opts->output, opts->frames);
+  if (!writer.ok()) {
+    qCritical("can't open output: %s", qUtf8Printable(opts->output));
+    return 1;
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+
+  // raw stream requires the same size for all frames, the first one defines it
+  QSize canvas;
+  qint64 last_half_second = opts->time.toMSecsSinceEpoch() / 500;
+  for (int i = 0; i < opts->frames && writer.ok(); i++) {
+    const auto dt = opts->time.addMSecs(qRound64(i * 1000 / opts->fps));
+    // separator blinks twice per second, as in clock window
+    if (auto hs = dt.toMSecsSinceEpoch() / 500; hs != last_half_second) {
+      skin->animateSeparator();
+      last_half_second = hs;
+    }
+    auto img = renderFrame(*skin->process(dt), opts->scale, canvas);
+    if (writer.isStream() && !canvas.isValid()) {
+      canvas = img.size();
+      qInfo("raw RGBA frames: %dx%d", canvas.width(), canvas.height());
+    }
+    writer.write(std::move(img), i);
+  }
+
+  writer.waitForDone();
+  qInfo("%d frames rendered in %lld ms", opts->frames, timer.elapsed());
+  return writer.ok() ? 0 : 1;
+}
@@ -0,0 +1,23 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+// headless mode: renders skin into image file(s) or raw frames stream
+// without any windows, doesn't require display (uses offscreen platform)
+//
+// examples:
+//   DigitalClockNext --render-to out.png --skin Electronic --time 2024-03-01T12:30:00
+//   DigitalClockNext --render-to frame_####.png --frames 100 --fps 25
+//   DigitalClockNext --render-to - --frames 1500 --fps 25 | ffmpeg -f rawvideo ...
+
+// checks command line for headless mode options,
+// must be called before any QCoreApplication instance is created
+bool isHeadlessMode(int argc, char** argv);
+
+// runs headless mode, creates its own application instance,
+// returns process exit code
+int runHeadless(int argc, char** argv);
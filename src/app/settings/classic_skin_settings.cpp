@@ -13,6 +13,7 @@
 
 #include <gradient_dialog.h>
 
+#include "app/clock_widget.hpp"
 #include "app_config.hpp"
 #include "classic_skin.hpp"
 
@@ -20,20 +21,27 @@ struct ClassicSkinSettings::Impl {
   WindowConfig* wcfg;
   ClassicSkinConfig* scfg;
 
-  ClassicSkin* skin;
+  ClassicSkin* skin_ptr;
+
+  // the skin may be in use by background rendering
+  ClassicSkin* skin() const
+  {
+    ClockWidget::waitForRendering();
+    return skin_ptr;
+  }
 
   Impl(ClassicSkin* skin, WindowConfig* wcfg)
     : wcfg(wcfg)
     , scfg(&wcfg->classicSkin())
-    , skin(skin)
+    , skin_ptr(skin)
     , last_path(QDir::homePath())
   {
-    skin->disableCaching();
+    this->skin()->disableCaching();
   }
 
   ~Impl()
   {
-    skin->enableCaching();
+    skin()->enableCaching();
   }
 
   QString last_path;
@@ -83,25 +91,25 @@ ClassicSkinSettings::~ClassicSkinSettings()
 void ClassicSkinSettings::on_orientation_cbox_activated(int index)
 {
   auto orientation = ui->orientation_cbox->itemData(index).value<Qt::Orientation>();
-  impl->skin->setOrientation(orientation);
+  impl->skin()->setOrientation(orientation);
   impl->scfg->setOrientation(orientation);
 }
 
 void ClassicSkinSettings::on_spacing_edit_valueChanged(int arg1)
 {
-  impl->skin->setSpacing(arg1);
+  impl->skin()->setSpacing(arg1);
   impl->scfg->setSpacing(arg1);
 }
 
 void ClassicSkinSettings::on_ignore_advance_x_clicked(bool checked)
 {
-  impl->skin->setIgnoreAdvanceX(checked);
+  impl->skin()->setIgnoreAdvanceX(checked);
   impl->scfg->setIgnoreAdvanceX(checked);
 }
 
 void ClassicSkinSettings::on_ignore_advance_y_clicked(bool checked)
 {
-  impl->skin->setIgnoreAdvanceY(checked);
+  impl->skin()->setIgnoreAdvanceY(checked);
   impl->scfg->setIgnoreAdvanceY(checked);
 }
 
@@ -119,13 +127,13 @@ void ClassicSkinSettings::on_texture_group_clicked(bool checked)
       brush = QBrush(impl->wcfg->state().getTexturePattern());
   }
   impl->scfg->setTexture(brush);
-  impl->skin->setTexture(std::move(brush));
+  impl->skin()->setTexture(std::move(brush));
 }
 
 void ClassicSkinSettings::on_tx_solid_color_rbtn_clicked()
 {
   impl->scfg->setTexture(impl->wcfg->state().getTextureColor());
-  impl->skin->setTexture(impl->wcfg->state().getTextureColor());
+  impl->skin()->setTexture(impl->wcfg->state().getTextureColor());
 }
 
 void ClassicSkinSettings::on_tx_select_color_btn_clicked()
@@ -137,13 +145,13 @@ void ClassicSkinSettings::on_tx_select_color_btn_clicked()
   if (!color.isValid()) return;
   impl->scfg->setTexture(color);
   impl->wcfg->state().setTextureColor(color);
-  impl->skin->setTexture(std::move(color));
+  impl->skin()->setTexture(std::move(color));
 }
 
 void ClassicSkinSettings::on_tx_gradient_rbtn_clicked()
 {
   impl->scfg->setTexture(impl->wcfg->state().getTextureGradient());
-  impl->skin->setTexture(impl->wcfg->state().getTextureGradient());
+  impl->skin()->setTexture(impl->wcfg->state().getTextureGradient());
 }
 
 void ClassicSkinSettings::on_tx_select_gradient_btn_clicked()
@@ -156,13 +164,13 @@ void ClassicSkinSettings::on_tx_select_gradient_btn_clicked()
   gradient.setCoordinateMode(QGradient::ObjectMode);
   impl->scfg->setTexture(gradient);
   impl->wcfg->state().setTextureGradient(gradient);
-  impl->skin->setTexture(std::move(gradient));
+  impl->skin()->setTexture(std::move(gradient));
 }
 
 void ClassicSkinSettings::on_tx_pattern_rbtn_clicked()
 {
   impl->scfg->setTexture(impl->wcfg->state().getTexturePattern());
-  impl->skin->setTexture(impl->wcfg->state().getTexturePattern());
+  impl->skin()->setTexture(impl->wcfg->state().getTexturePattern());
 }
 
 void ClassicSkinSettings::on_tx_select_pattern_btn_clicked()
@@ -176,19 +184,19 @@ void ClassicSkinSettings::on_tx_select_pattern_btn_clicked()
   QPixmap pxm(file);
   impl->scfg->setTexture(pxm);
   impl->wcfg->state().setTexturePattern(pxm);
-  impl->skin->setTexture(std::move(pxm));
+  impl->skin()->setTexture(std::move(pxm));
 }
 
 void ClassicSkinSettings::on_tx_pattern_stretch_clicked(bool checked)
 {
   impl->scfg->setTextureStretch(checked);
-  impl->skin->setTextureStretch(checked);
+  impl->skin()->setTextureStretch(checked);
 }
 
 void ClassicSkinSettings::on_tx_per_element_cb_clicked(bool checked)
 {
   impl->scfg->setTexturePerElement(checked);
-  impl->skin->setTexturePerElement(checked);
+  impl->skin()->setTexturePerElement(checked);
 }
 
 void ClassicSkinSettings::on_background_group_clicked(bool checked)
@@ -205,13 +213,13 @@ void ClassicSkinSettings::on_background_group_clicked(bool checked)
       brush = QBrush(impl->wcfg->state().getBackgroundPattern());
   }
   impl->scfg->setBackground(brush);
-  impl->skin->setBackground(std::move(brush));
+  impl->skin()->setBackground(std::move(brush));
 }
 
 void ClassicSkinSettings::on_bg_solid_color_rbtn_clicked()
 {
   impl->scfg->setBackground(impl->wcfg->state().getBackgroundColor());
-  impl->skin->setBackground(impl->wcfg->state().getBackgroundColor());
+  impl->skin()->setBackground(impl->wcfg->state().getBackgroundColor());
 }
 
 void ClassicSkinSettings::on_bg_select_color_btn_clicked()
@@ -223,13 +231,13 @@ void ClassicSkinSettings::on_bg_select_color_btn_clicked()
   if (!color.isValid()) return;
   impl->scfg->setBackground(color);
   impl->wcfg->state().setBackgroundColor(color);
-  impl->skin->setBackground(std::move(color));
+  impl->skin()->setBackground(std::move(color));
 }
 
 void ClassicSkinSettings::on_bg_gradient_rbtn_clicked()
 {
   impl->scfg->setBackground(impl->wcfg->state().getBackgroundGradient());
-  impl->skin->setBackground(impl->wcfg->state().getBackgroundGradient());
+  impl->skin()->setBackground(impl->wcfg->state().getBackgroundGradient());
 }
 
 void ClassicSkinSettings::on_bg_select_gradient_btn_clicked()
@@ -242,13 +250,13 @@ void ClassicSkinSettings::on_bg_select_gradient_btn_clicked()
   gradient.setCoordinateMode(QGradient::ObjectMode);
   impl->scfg->setBackground(gradient);
   impl->wcfg->state().setBackgroundGradient(gradient);
-  impl->skin->setBackground(std::move(gradient));
+  impl->skin()->setBackground(std::move(gradient));
 }
 
 void ClassicSkinSettings::on_bg_pattern_rbtn_clicked()
 {
   impl->scfg->setBackground(impl->wcfg->state().getBackgroundPattern());
-  impl->skin->setBackground(impl->wcfg->state().getBackgroundPattern());
+  impl->skin()->setBackground(impl->wcfg->state().getBackgroundPattern());
 }
 
 void ClassicSkinSettings::on_bg_select_pattern_btn_clicked()
@@ -262,17 +270,17 @@ void ClassicSkinSettings::on_bg_select_pattern_btn_clicked()
   QPixmap pxm(file);
   impl->scfg->setBackground(pxm);
   impl->wcfg->state().setBackgroundPattern(pxm);
-  impl->skin->setBackground(std::move(pxm));
+  impl->skin()->setBackground(std::move(pxm));
 }
 
 void ClassicSkinSettings::on_bg_pattern_stretch_clicked(bool checked)
 {
   impl->scfg->setBackgroundStretch(checked);
-  impl->skin->setBackgroundStretch(checked);
+  impl->skin()->setBackgroundStretch(checked);
 }
 
 void ClassicSkinSettings::on_bg_per_element_cb_clicked(bool checked)
 {
   impl->scfg->setBackgroundPerElement(checked);
-  impl->skin->setBackgroundPerElement(checked);
+  impl->skin()->setBackgroundPerElement(checked);
 }
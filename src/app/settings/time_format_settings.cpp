@@ -10,6 +10,7 @@
 #include <QtCore/QSet>
 #include <QtGui/QDesktopServices>
 
+#include "app/clock_widget.hpp"
 #include "app_config.hpp"
 #include "classic_skin.hpp"
 
@@ -33,12 +34,19 @@ struct TimeFormatSettings::Impl {
   WindowConfig* wcfg;
   ClassicSkinConfig* scfg;
 
-  ClassicSkin* skin;
+  ClassicSkin* skin_ptr;
+
+  // the skin may be in use by background rendering
+  ClassicSkin* skin() const
+  {
+    ClockWidget::waitForRendering();
+    return skin_ptr;
+  }
 
   Impl(ClassicSkin* skin, WindowConfig* wcfg) noexcept
     : wcfg(wcfg)
     , scfg(&wcfg->classicSkin())
-    , skin(skin)
+    , skin_ptr(skin)
   {}
 };
 
@@ -78,8 +86,8 @@ TimeFormatSettings::TimeFormatSettings(ClassicSkin* skin, WindowConfig* wcfg, QW
   // but the same logic should be triggered on initialization (regardless of the state)
   on_use_custom_format_toggled(ui->use_custom_format->isChecked());
 
-  ui->custom_seps_label->setEnabled(impl->skin->supportsCustomSeparator());
-  ui->custom_seps_edit->setEnabled(impl->skin->supportsCustomSeparator());
+  ui->custom_seps_label->setEnabled(impl->skin()->supportsCustomSeparator());
+  ui->custom_seps_edit->setEnabled(impl->skin()->supportsCustomSeparator());
   ui->custom_seps_edit->setText(impl->scfg->getCustomSeparators());
 
   ui->layout_cfg_edit->setText(impl->scfg->getLayoutConfig());
@@ -115,7 +123,7 @@ void TimeFormatSettings::on_smaller_seconds_clicked(bool checked)
 void TimeFormatSettings::on_seconds_scale_factor_edit_valueChanged(int arg1)
 {
   auto ssf = arg1 / 100.;
-  impl->skin->setTokenTransform("ss", QTransform::fromScale(ssf, ssf));
+  impl->skin()->setTokenTransform("ss", QTransform::fromScale(ssf, ssf));
   impl->scfg->setSecondsScaleFactor(arg1);
 }
 
@@ -156,19 +164,19 @@ void TimeFormatSettings::on_format_help_btn_clicked()
 void TimeFormatSettings::on_format_apply_btn_clicked()
 {
   auto time_format = ui->format_edit->text();
-  impl->skin->setFormat(time_format);
+  impl->skin()->setFormat(time_format);
   impl->scfg->setTimeFormat(time_format);
 }
 
 void TimeFormatSettings::on_custom_seps_edit_textEdited(const QString& arg1)
 {
-  impl->skin->setCustomSeparators(arg1);
+  impl->skin()->setCustomSeparators(arg1);
   impl->scfg->setCustomSeparators(arg1);
 }
 
 void TimeFormatSettings::on_layout_cfg_edit_textEdited(const QString& arg1)
 {
-  impl->skin->setLayoutConfig(arg1);
+  impl->skin()->setLayoutConfig(arg1);
   impl->scfg->setLayoutConfig(arg1);
 }
 
@@ -9,11 +9,22 @@
 #include <algorithm>
 #include <iterator>
 #include <optional>
+#include <vector>
 
 #include <QApplication>
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QScreen>
 #include <QStandardPaths>
+#include <QThread>
+#include <QThreadPool>
 
+#include "app/clock_widget.hpp"
 #include "font_resource.hpp"
 #include "error_skin.hpp"
 #include "legacy_skin_loader.hpp"
@@ -29,9 +40,21 @@ std::optional<QString> tryLegacySkin(const QString& path)
   return std::nullopt;
 }
 
+// device scales of all screens, vector skins are pre-rendered for them
+QList<qreal> screenScales()
+{
+  QList<qreal> scales;
+  for (const auto* screen : QGuiApplication::screens())
+    if (!scales.contains(screen->devicePixelRatio()))
+      scales.append(screen->devicePixelRatio());
+  return scales;
+}
+
 auto loadLegacySkin(const QString& skin_path)
 {
   LegacySkinLoader loader(skin_path);
+  loader.setPrefetchEnabled(true);
+  loader.setWarmUpScales(screenScales());
   auto skin = loader.skin();
   return skin;
 }
@@ -51,6 +74,205 @@ auto loadModernSkin(const QString& skin_path)
   return skin;
 }
 
+using SkinType = SkinManagerImpl::SkinType;
+using SkinsMap = SkinManagerImpl::SkinsMap;
+
+// search result for single directory entry, negative results are stored
+// too, so any entry that was not changed since the last search costs only
+// a few stat() calls (directory itself and its config files)
+struct IndexEntry {
+  qint64 mtime = 0;
+  std::optional<SkinType> type;
+  QString title;
+
+  bool operator==(const IndexEntry&) const = default;
+};
+
+using SkinsIndex = QHash<QString, IndexEntry>;
+
+constexpr int index_version = 2;
+
+QString indexFilePath()
+{
+  using namespace Qt::Literals::StringLiterals;
+  auto cache_dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+  return cache_dir.isEmpty() ? QString() : QDir(cache_dir).absoluteFilePath(u"skins_index.json"_s);
+}
+
+SkinsIndex loadIndex(const QString& filename)
+{
+  QFile f(filename);
+  if (filename.isEmpty() || !f.open(QIODevice::ReadOnly))
+    return {};
+
+  const auto doc = QJsonDocument::fromJson(f.readAll()).object();
+  if (doc.value("version").toInt() != index_version)
+    return {};
+
+  SkinsIndex index;
+  for (const auto v : doc.value("entries").toArray()) {
+    const auto o = v.toObject();
+    IndexEntry e;
+    e.mtime = o.value("mtime").toInteger();
+    switch (o.value("type").toInt(-1)) {
+      case 0: e.type = SkinType::Legacy; break;
+      case 1: e.type = SkinType::Modern; break;
+      default: break;
+    }
+    e.title = o.value("title").toString();
+    index.insert(o.value("path").toString(), e);
+  }
+  return index;
+}
+
+void saveIndex(const QString& filename, const SkinsIndex& index)
+{
+  if (filename.isEmpty() || !QDir().mkpath(QFileInfo(filename).absolutePath()))
+    return;
+
+  QJsonArray entries;
+  for (auto iter = index.cbegin(); iter != index.cend(); ++iter) {
+    QJsonObject o;
+    o["path"] = iter.key();
+    o["mtime"] = iter->mtime;
+    o["type"] = iter->type ? static_cast<int>(*iter->type) : -1;
+    o["title"] = iter->title;
+    entries.append(o);
+  }
+
+  QJsonObject doc;
+  doc["version"] = index_version;
+  doc["entries"] = entries;
+
+  QSaveFile f(filename);
+  if (!f.open(QIODevice::WriteOnly))
+    return;
+  f.write(QJsonDocument(doc).toJson(QJsonDocument::Compact));
+  f.commit();
+}
+
+IndexEntry validateSkin(const QString& skin_path, qint64 mtime)
+{
+  constexpr std::pair<SkinType, std::optional<QString>(*)(const QString&)> validators[] = {
+    {SkinType::Legacy, &tryLegacySkin},
+    {SkinType::Modern, &tryModernSkin},
+  };
+
+  IndexEntry entry{mtime, std::nullopt, {}};
+  for (const auto& [type, validator] : validators) {
+    if (auto name = (*validator)(skin_path)) {
+      entry.type = type;
+      entry.title = *name;
+      break;
+    }
+  }
+  return entry;
+}
+
+// mtime is not available for embedded resources, 0 means "always validate"
+qint64 modificationTime(const QFileInfo& fi)
+{
+  const auto dt = fi.lastModified();
+  return dt.isValid() ? dt.toMSecsSinceEpoch() : 0;
+}
+
+// files read by skin validators, editing them in place doesn't change
+// directory's mtime, other files matter only by their existence
+constexpr const char* skin_config_files[] = {"skin.ini", "geometry.ini", "skin.json"};
+
+// the latest mtime of the entry and its config files
+qint64 skinModificationTime(const QString& path)
+{
+  const QFileInfo fi(path);
+  auto mtime = modificationTime(fi);
+  if (mtime == 0 || !fi.isDir())
+    return mtime;
+
+  const QDir dir(path);
+  for (const auto* name : skin_config_files)
+    if (QFileInfo cfg(dir.filePath(QLatin1StringView(name))); cfg.exists())
+      mtime = std::max(mtime, modificationTime(cfg));
+  return mtime;
+}
+
+// skins known from the previous search, available before search is finished
+SkinsMap skinsFromIndex(const QStringList& search_paths, const SkinsIndex& index)
+{
+  auto paths = index.keys();
+  paths.sort();
+
+  SkinsMap skins;
+  for (const auto& search_path : search_paths) {
+    const auto prefix = QDir(search_path).absolutePath() + QLatin1Char('/');
+    for (const auto& path : std::as_const(paths))
+      if (const auto& e = index[path]; e.type && path.startsWith(prefix))
+        skins[e.title] = {*e.type, path};
+  }
+  return skins;
+}
+
+// embedded skins are never indexed (they have no mtime), but validating
+// them is cheap, and the default skin is one of them, so it never waits
+SkinsMap embeddedSkins(const QString& search_path)
+{
+  SkinsMap skins;
+  const QDir dir(search_path);
+  const auto items = dir.entryList(QDir::AllEntries | QDir::NoDotAndDotDot);
+  for (const auto& item : items) {
+    const auto path = dir.absoluteFilePath(item);
+    if (const auto e = validateSkin(path, 0); e.type)
+      skins[e.title] = {*e.type, path};
+  }
+  return skins;
+}
+
+// runs in background thread
+SkinsMap searchSkins(const QStringList& search_paths, const SkinsIndex& old_index, const QString& index_file)
+{
+  QStringList entries;
+  for (const auto& path : search_paths) {
+    QDir dir(path);
+    if (!dir.exists())
+      continue;
+    const auto items = dir.entryList(QDir::AllEntries | QDir::NoDotAndDotDot);
+    for (const auto& item : items)
+      entries.append(dir.absoluteFilePath(item));
+  }
+
+  // entries are checked in parallel, but results order is preserved,
+  // skins found later (in more specific locations) override earlier ones
+  std::vector<IndexEntry> results(entries.size());
+  QThreadPool pool;
+  // mostly waiting for I/O (e.g. network file systems), not CPU
+  pool.setMaxThreadCount(std::max(QThread::idealThreadCount(), 8));
+  for (qsizetype i = 0; i < entries.size(); i++) {
+    pool.start([&entries, &old_index, &results, i]() {
+      const auto& path = entries[i];
+      const auto mtime = skinModificationTime(path);
+      auto iter = old_index.find(path);
+      results[i] = mtime != 0 && iter != old_index.end() && iter->mtime == mtime
+                   ? *iter
+                   : validateSkin(path, mtime);
+    });
+  }
+  pool.waitForDone();
+
+  SkinsMap skins;
+  SkinsIndex new_index;
+  for (qsizetype i = 0; i < entries.size(); i++) {
+    const auto& e = results[i];
+    if (e.type)
+      skins[e.title] = {*e.type, entries[i]};
+    if (e.mtime != 0)
+      new_index.insert(entries[i], e);
+  }
+
+  if (new_index != old_index)
+    saveIndex(index_file, new_index);
+
+  return skins;
+}
+
 } // namespace
 
 SkinManagerImpl::SkinManagerImpl(ApplicationPrivate* app, QObject* parent)
@@ -71,16 +293,12 @@ SkinManager::SkinPtr SkinManagerImpl::loadSkin(const QFont& font) const
 
 SkinManager::SkinPtr SkinManagerImpl::loadSkin(const QString& skin_name) const
 {
-  auto iter = _skins.find(skin_name);
-  if (iter != _skins.end()) {
-    switch (iter.value().type) {
-      case SkinType::Legacy:
-        return loadLegacySkin(iter.value().path);
-      case SkinType::Modern:
-        return loadModernSkin(iter.value().path);
-    }
-  }
-  return std::make_unique<ErrorSkin>();
+  // skin known from the previous run may be already gone or changed,
+  // wait for the actual search results in that case
+  auto skin = tryLoadSkin(skin_name);
+  if ((!skin || !*skin) && waitForSkins())
+    skin = tryLoadSkin(skin_name);
+  return skin ? *skin : std::make_unique<ErrorSkin>();
 }
 
 SkinManager::SkinPtr SkinManagerImpl::loadSkin(std::size_t i) const
@@ -100,11 +318,13 @@ SkinManager::SkinPtr SkinManagerImpl::loadSkin(std::size_t i) const
 void SkinManagerImpl::configureSkin(const SkinPtr& skin, std::size_t i) const
 {
   SkinConfigurator visitor(_app->app_config()->window(i));
+  ClockWidget::waitForRendering();   // the skin may be in use
   skin->visit(visitor);
 }
 
 QStringList SkinManagerImpl::availableSkins() const
 {
+  waitForSkins();
   QStringList skins = _skins.keys();
   skins.sort();
   return skins;
@@ -112,7 +332,8 @@ QStringList SkinManagerImpl::availableSkins() const
 
 void SkinManagerImpl::findSkins()
 {
-  _skins.clear();
+  // previous search must be finished, it may still use old index file
+  waitForSkins();
 
   using namespace Qt::Literals::StringLiterals;
   QStringList search_paths = {
@@ -133,26 +354,39 @@ void SkinManagerImpl::findSkins()
                  std::back_inserter(search_paths),
                  [](const QString& path) { return QDir(path).absoluteFilePath(u"skins"_s); });
 
-  constexpr std::pair<SkinType, std::optional<QString>(*)(const QString&)> validators[] = {
-    {SkinType::Legacy, &tryLegacySkin},
-    {SkinType::Modern, &tryModernSkin},
-  };
+  const auto index_file = indexFilePath();
+  auto index = loadIndex(index_file);
+  if (_skins.isEmpty()) {
+    // embedded skins are searched first, so others override them
+    _skins = embeddedSkins(search_paths.front());
+    _skins.insert(skinsFromIndex(search_paths, index));
+  }
 
-  for (const auto& path : std::as_const(search_paths)) {
-    QDir dir(path);
-    if (!dir.exists())
-      continue;
-    const auto items = dir.entryList(QDir::AllEntries | QDir::NoDotAndDotDot);
-    for (const auto& item : items) {
-      auto skin_path = dir.absoluteFilePath(item);
-      for (const auto& [type, validator] : validators) {
-        if (auto name = (*validator)(skin_path)) {
-          _skins[*name] = {type, skin_path};
-          break;
-        }
-      }
-    }
+  _pending = std::async(std::launch::async, &searchSkins,
+                        std::move(search_paths), std::move(index), index_file);
+}
+
+std::optional<SkinManager::SkinPtr> SkinManagerImpl::tryLoadSkin(const QString& skin_name) const
+{
+  auto iter = _skins.find(skin_name);
+  if (iter == _skins.end())
+    return std::nullopt;
+
+  switch (iter.value().type) {
+    case SkinType::Legacy:
+      return loadLegacySkin(iter.value().path);
+    case SkinType::Modern:
+      return loadModernSkin(iter.value().path);
   }
+  return std::nullopt;
+}
+
+bool SkinManagerImpl::waitForSkins() const
+{
+  if (!_pending.valid())
+    return false;
+  _skins = _pending.get();
+  return true;
 }
 
 void SkinConfigurator::visit(ClassicSkin* skin)
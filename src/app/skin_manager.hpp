@@ -8,6 +8,9 @@
 
 #include "application_private.hpp"
 
+#include <future>
+#include <optional>
+
 #include "skin_visitor.hpp"
 
 class SkinConfigurator final : public SkinVisitor
@@ -42,11 +45,11 @@ public:
   QStringList availableSkins() const override;
 
 public slots:
+  // skins are searched in background, skins found during the previous run
+  // (stored in the index file) are available immediately
   void findSkins() override;
 
-private:
-  ApplicationPrivate* _app;
-
+public:
   enum class SkinType {
     Legacy,
     Modern,
@@ -57,5 +60,16 @@ private:
     QString path;
   };
 
-  QHash<QString, LoaderInfo> _skins;
+  using SkinsMap = QHash<QString, LoaderInfo>;
+
+private:
+  std::optional<SkinPtr> tryLoadSkin(const QString& skin_name) const;
+  // takes background search results if any, returns false if nothing was pending
+  bool waitForSkins() const;
+
+private:
+  ApplicationPrivate* _app;
+
+  mutable SkinsMap _skins;
+  mutable std::future<SkinsMap> _pending;
 };
@@ -8,20 +8,41 @@
 
 #include <QObject>
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
 #include <QDateTime>
 #include <QTimer>
 
+/**
+ * @brief Time ticks provider
+ *
+ * Emits timeChanged() right after the time crosses the boundary of
+ * some interval (e.g. second, minute, or half of a second for separator
+ * animation). Interval is requested each time when the next tick is
+ * scheduled, so it should always reflect what is currently displayed.
+ *
+ * The timer is re-armed from the wall clock on every wakeup, so there is
+ * no accumulated drift. System clock changes are detected as a change of
+ * the interval "bucket" and are handled with bounded delay.
+ */
 class TimeSource : public QObject
 {
   Q_OBJECT
 
 public:
+  using Interval = std::chrono::milliseconds;
+  using IntervalProvider = std::function<Interval()>;
+
   explicit TimeSource(QObject* parent = nullptr)
     : QObject(parent)
+    , _last_tick(QDateTime::currentMSecsSinceEpoch())
   {
+    _timer.setSingleShot(true);
+    _timer.setTimerType(Qt::PreciseTimer);
     connect(&_timer, &QTimer::timeout, this, &TimeSource::onTimeout);
-    using namespace std::chrono_literals;
-    _timer.start(500ms);
+    schedule();
   }
 
   ~TimeSource()
@@ -31,16 +52,62 @@ public:
 
   QDateTime now() const { return QDateTime::currentDateTimeUtc(); }
 
+  void setIntervalProvider(IntervalProvider provider)
+  {
+    _interval_provider = std::move(provider);
+    schedule();
+  }
+
+  // how late the last tick was relative to the boundary it belongs to
+  Interval lastTickLatency() const noexcept { return _latency; }
+
+public slots:
+  // should be called when interval may change
+  void reschedule() { schedule(); }
+
 signals:
-  // provides current UTC time, interval is unspecified
+  // provides current UTC time, emitted at interval boundaries
   void timeChanged(const QDateTime& dt);
 
 private slots:
   void onTimeout()
   {
-    emit timeChanged(now());
+    const auto interval = currentInterval();
+    const auto now_ms = QDateTime::currentMSecsSinceEpoch();
+    // timer may fire a bit earlier, or clock may be changed,
+    // so emit only if wall clock is really in another interval
+    if (now_ms / interval != _last_tick / interval) {
+      _latency = Interval(now_ms % interval);
+      _last_tick = now_ms;
+      emit timeChanged(QDateTime::fromMSecsSinceEpoch(now_ms).toUTC());
+    }
+    schedule();
+  }
+
+private:
+  qint64 currentInterval() const
+  {
+    using namespace std::chrono_literals;
+    auto interval = _interval_provider ? _interval_provider() : Interval(500ms);
+    return std::clamp<qint64>(interval.count(), 1, max_interval.count());
+  }
+
+  void schedule()
+  {
+    const auto interval = currentInterval();
+    const auto now_ms = QDateTime::currentMSecsSinceEpoch();
+    const auto next_tick = (now_ms / interval + 1) * interval;
+    // don't sleep too long to catch up system clock changes
+    _timer.start(std::min<qint64>(next_tick - now_ms, max_sleep.count()));
   }
 
 private:
+  static constexpr Interval max_interval = std::chrono::minutes(1);
+  // also the maximum delay for system clock change handling
+  static constexpr Interval max_sleep = std::chrono::seconds(10);
+
   QTimer _timer;
+  IntervalProvider _interval_provider;
+  qint64 _last_tick;
+  Interval _latency = Interval::zero();
 };
@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "display_list.hpp"
+
+#include <algorithm>
+#include <utility>
+
+DisplayList DisplayList::record(std::shared_ptr<Resource> res)
+{
+  DisplayList list;
+  if (!res) return list;
+
+  DisplayListRecorder recorder(list._commands);
+  recorder.add(res, QTransform());
+  list._source_key = res->cacheKey();
+  list._source = std::move(res);
+  return list;
+}
+
+void DisplayList::replay(QPainter* p) const
+{
+  // leaf resources restore painter's state themselves,
+  // only transform and composition mode are changed here
+  const auto base = p->transform();
+  const auto base_mode = p->compositionMode();
+  auto mode = base_mode;
+
+  for (const auto& c : _commands) {
+    p->setTransform(c.transform * base);
+    if (c.mode != mode) {
+      mode = c.mode;
+      p->setCompositionMode(mode);
+    }
+    c.res->draw(p);
+  }
+
+  p->setTransform(base);
+  if (mode != base_mode) p->setCompositionMode(base_mode);
+}
+
+QRectF DisplayList::diff(const DisplayList& other) const
+{
+  QRectF r;
+  const auto& lhs = _commands;
+  const auto& rhs = other._commands;
+  const auto n = std::min(lhs.size(), rhs.size());
+
+  for (std::size_t i = 0; i < n; i++) {
+    const auto& a = lhs[i];
+    const auto& b = rhs[i];
+    if (a.key != b.key || a.mode != b.mode || a.transform != b.transform || a.bounds != b.bounds)
+      r |= a.bounds | b.bounds;
+  }
+
+  for (std::size_t i = n; i < lhs.size(); i++) r |= lhs[i].bounds;
+  for (std::size_t i = n; i < rhs.size(); i++) r |= rhs[i].bounds;
+
+  return r;
+}
+
+void DisplayListRecorder::add(const std::shared_ptr<Resource>& res, const QTransform& t,
+                              std::optional<QPainter::CompositionMode> mode)
+{
+  Q_ASSERT(res);
+  const auto saved_transform = std::exchange(_transform, t * _transform);
+  const auto saved_mode = std::exchange(_mode, mode.value_or(_mode));
+
+  if (!res->record(*this))
+    _commands.push_back({_transform, res, _mode, res->cacheKey(), _transform.mapRect(res->rect())});
+
+  _transform = saved_transform;
+  _mode = saved_mode;
+}
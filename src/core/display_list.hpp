@@ -0,0 +1,85 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <QPainter>
+#include <QTransform>
+
+#include "resource.hpp"
+
+/**
+ * @brief Recorded drawing of a resource tree
+ *
+ * Composite resources (layouts) are flattened, so the list is just
+ * a sequence of leaf resources with their final transforms. Replay
+ * doesn't walk the tree and doesn't use painter's state stack.
+ *
+ * List can be re-used while the recorded resource's cache key remains
+ * the same, and two lists can be compared to find changed area.
+ */
+class DisplayList final {
+public:
+  struct Command {
+    QTransform transform;   // resource coordinates to list coordinates
+    std::shared_ptr<Resource> res;
+    QPainter::CompositionMode mode = QPainter::CompositionMode_SourceOver;
+    size_t key = 0;         // resource's cache key at recording time
+    QRectF bounds;          // resource's rect in list coordinates
+  };
+
+  DisplayList() = default;
+
+  // list coordinates are the given resource's coordinates
+  static DisplayList record(std::shared_ptr<Resource> res);
+
+  bool isEmpty() const noexcept { return _commands.empty(); }
+  const std::vector<Command>& commands() const noexcept { return _commands; }
+
+  // true if list was recorded from the given resource and it is unchanged,
+  // resources without cache key (-1) are always considered as changed
+  bool isRecordedFrom(const std::shared_ptr<Resource>& res) const
+  {
+    return res && res == _source && _source_key != size_t(-1) && res->cacheKey() == _source_key;
+  }
+
+  void replay(QPainter* p) const;
+
+  // area (in list coordinates) that differs between two lists, commands
+  // are matched by their order, empty rect means that lists are the same
+  QRectF diff(const DisplayList& other) const;
+
+private:
+  std::vector<Command> _commands;
+  std::shared_ptr<Resource> _source;
+  size_t _source_key = 0;
+};
+
+
+// passed to Resource::record()
+class DisplayListRecorder final {
+public:
+  // adds resource (or its parts) with the given transform, relative to the
+  // current resource, composition mode (if any) is applied to all its parts
+  void add(const std::shared_ptr<Resource>& res, const QTransform& t,
+           std::optional<QPainter::CompositionMode> mode = std::nullopt);
+
+private:
+  friend class DisplayList;
+
+  explicit DisplayListRecorder(std::vector<DisplayList::Command>& commands) noexcept
+    : _commands(commands)
+  {}
+
+private:
+  std::vector<DisplayList::Command>& _commands;
+  QTransform _transform;
+  QPainter::CompositionMode _mode = QPainter::CompositionMode_SourceOver;
+};
@@ -0,0 +1,333 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "flat_layout.hpp"
+
+#include <algorithm>
+
+#include <QPainter>
+
+#include "display_list.hpp"
+#include "hasher.hpp"
+#include "layout.hpp"
+#include "linear_layout_algorithm.hpp"
+
+// LinearLayoutAlgorithm items accessor for layout node's children
+class FlatLayoutItems {
+public:
+  FlatLayoutItems(FlatLayout& l, FlatLayout::NodeId id) noexcept
+    : _l(l)
+    , _items(l.children(id))
+  {}
+
+  std::size_t size() const noexcept { return _items.size(); }
+
+  QRectF rect(std::size_t i) const noexcept { return _l._rect[_items[i]]; }
+  QPointF pos(std::size_t i) const noexcept { return _l._pos[_items[i]]; }
+  void setPos(std::size_t i, QPointF p) noexcept { _l._pos[_items[i]] = std::move(p); }
+  qreal ax(std::size_t i) const noexcept { return _l._advance[_items[i]].x(); }
+  qreal ay(std::size_t i) const noexcept { return _l._advance[_items[i]].y(); }
+
+  bool resizeEnabled(std::size_t i) const noexcept
+  {
+    return _l._flags[_items[i]] & FlatLayout::ResizeEnabled;
+  }
+
+  Qt::Alignment alignment(std::size_t i) const noexcept { return _l._alignment[_items[i]]; }
+
+  // the same as LayoutItem::resize()
+  void resize(std::size_t i, qreal l, Qt::Orientation o)
+  {
+    const auto id = _items[i];
+    const auto& r = _l._rect[id];
+    _l._ks[id] *= l / (o == Qt::Horizontal ? r.width() : r.height());
+    _l.updateItemGeometry(id);
+  }
+
+private:
+  FlatLayout& _l;
+  const std::span<const FlatLayout::NodeId> _items;
+};
+
+FlatLayout::FlatLayout(std::pmr::memory_resource* mr)
+  : _parent(mr)
+  , _first_child(mr)
+  , _child_count(mr)
+  , _children(mr)
+  , _flags(mr)
+  , _orientation(mr)
+  , _spacing(mr)
+  , _line_metrics(mr)
+  , _res(mr)
+  , _transform(mr)
+  , _alignment(mr)
+  , _pos(mr)
+  , _ks(mr)
+  , _content(mr)
+  , _content_advance(mr)
+  , _rect(mr)
+  , _advance(mr)
+  , _root_transform(mr)
+{
+}
+
+void FlatLayout::reserve(NodeId n)
+{
+  auto reserve_all = [n](auto&... v) { (v.reserve(n), ...); };
+  reserve_all(_parent, _first_child, _child_count, _children, _flags,
+              _orientation, _spacing, _line_metrics,
+              _res, _transform, _alignment, _pos, _ks,
+              _content, _content_advance, _rect, _advance, _root_transform);
+}
+
+FlatLayout::NodeId FlatLayout::addLayout(NodeId parent, Qt::Orientation o,
+                                         qreal spacing, bool ignore_advance)
+{
+  auto id = addNode(parent, IsLayout | (ignore_advance ? IgnoreAdvance : 0));
+  _orientation[id] = o;
+  _spacing[id] = spacing;
+  return id;
+}
+
+FlatLayout::NodeId FlatLayout::addItem(NodeId parent, std::shared_ptr<Resource> res, QTransform t)
+{
+  Q_ASSERT(res);
+  Q_ASSERT(parent != no_node);
+  auto id = addNode(parent, 0);
+  _res[id] = std::move(res);
+  _transform[id] = std::move(t);
+  return id;
+}
+
+FlatLayout::NodeId FlatLayout::addNode(NodeId parent, std::uint8_t flags)
+{
+  Q_ASSERT(parent == no_node ? _parent.empty() : parent < size() && isLayout(parent));
+  const auto id = size();
+
+  _parent.push_back(parent);
+  _first_child.push_back(0);
+  _child_count.push_back(0);
+  _flags.push_back(flags);
+
+  _orientation.push_back(Qt::Horizontal);
+  _spacing.push_back(0);
+  _line_metrics.emplace_back(0, 0);
+
+  _res.emplace_back();
+  _transform.emplace_back();
+  _alignment.push_back(Qt::AlignBaseline | Qt::AlignJustify);
+  _pos.emplace_back(0, 0);
+  _ks.push_back(1.0);
+
+  _content.emplace_back();
+  _content_advance.emplace_back();
+  _rect.emplace_back();
+  _advance.emplace_back();
+  _root_transform.emplace_back();
+
+  _structure_changed = true;
+  _geometry_dirty = true;
+  _cache_key.reset();
+  return id;
+}
+
+void FlatLayout::setAlignment(NodeId id, Qt::Alignment a) noexcept
+{
+  _alignment[id] = a;
+  _geometry_dirty = true;
+}
+
+void FlatLayout::setResizeEnabled(NodeId id, bool enabled) noexcept
+{
+  if (enabled)
+    _flags[id] |= ResizeEnabled;
+  else
+    _flags[id] &= ~ResizeEnabled;
+  _ks[id] = 1.0;
+  _geometry_dirty = true;
+}
+
+void FlatLayout::setLineMetrics(NodeId id, qreal ascent, qreal descent) noexcept
+{
+  _flags[id] |= HasLineMetrics;
+  _line_metrics[id] = {ascent, descent};
+  _geometry_dirty = true;
+}
+
+bool FlatLayout::setResource(NodeId id, std::shared_ptr<Resource> res)
+{
+  Q_ASSERT(res);
+  Q_ASSERT(!isLayout(id));
+  _cache_key.reset();
+  if (res == _res[id]) return false;
+  bool changed = res->rect() != _content[id] ||
+                 res->advanceX() != _content_advance[id].x() ||
+                 res->advanceY() != _content_advance[id].y();
+  _res[id] = std::move(res);
+  _geometry_dirty |= changed;
+  return changed;
+}
+
+void FlatLayout::updateGeometry()
+{
+  if (!_geometry_dirty) return;
+
+  if (_structure_changed) {
+    updateChildrenRanges();
+    _structure_changed = false;
+  }
+
+  // children always have greater ids than their parents,
+  // so reverse order scan is a bottom-up pass
+  for (auto id = size(); id-- > 0;) {
+    if (isLayout(id)) {
+      updateLayoutGeometry(id);
+    } else {
+      const auto& r = _res[id];
+      _content[id] = r->rect();
+      _content_advance[id] = QPointF(r->advanceX(), r->advanceY());
+    }
+    updateItemGeometry(id);
+  }
+  // the whole tree is rebuilt at once
+  LayoutItem::countRecalculatedItems(size());
+
+  // and direct order scan is a top-down pass
+  // root's own position/transform is not a part of its content
+  if (size() > 0) _root_transform[0] = QTransform();
+  for (NodeId id = 1; id < size(); id++)
+    _root_transform[id] = localTransform(id) * _root_transform[_parent[id]];
+
+  _geometry_dirty = false;
+  _cache_key.reset();
+}
+
+QRectF FlatLayout::rect() const
+{
+  return _content.empty() ? QRectF() : _content.front();
+}
+
+qreal FlatLayout::advanceX() const
+{
+  return _content_advance.empty() ? 0 : _content_advance.front().x();
+}
+
+qreal FlatLayout::advanceY() const
+{
+  return _content_advance.empty() ? 0 : _content_advance.front().y();
+}
+
+void FlatLayout::draw(QPainter* p)
+{
+  Q_ASSERT(!_geometry_dirty);
+  const auto base = p->transform();
+  for (NodeId id = 0; id < size(); id++) {
+    const auto& r = _res[id];
+    if (!r) continue;
+    p->save();
+    p->setTransform(_root_transform[id] * base);
+    r->draw(p);
+    p->restore();
+  }
+}
+
+bool FlatLayout::record(DisplayListRecorder& r) const
+{
+  Q_ASSERT(!_geometry_dirty);
+  for (NodeId id = 0; id < size(); id++)
+    if (const auto& res = _res[id])
+      r.add(res, _root_transform[id]);
+  return true;
+}
+
+size_t FlatLayout::cacheKey() const
+{
+  if (!_cache_key) {
+    // items with their transforms are enough, layouts draw nothing
+    size_t key = size();
+    for (NodeId id = 0; id < size(); id++) {
+      if (!_res[id]) continue;
+      key = hashCombine(key, _res[id]->cacheKey());
+      key = hashCombine(key, qHash(_root_transform[id]));
+    }
+    _cache_key = key;
+  }
+  return *_cache_key;
+}
+
+void FlatLayout::updateChildrenRanges()
+{
+  std::fill(_child_count.begin(), _child_count.end(), 0);
+  for (NodeId id = 1; id < size(); id++)
+    ++_child_count[_parent[id]];
+
+  NodeId first = 0;
+  for (NodeId id = 0; id < size(); id++) {
+    _first_child[id] = first;
+    first += _child_count[id];
+    _child_count[id] = 0;
+  }
+
+  // ids are ascending, so children keep order they were added
+  _children.resize(first);
+  for (NodeId id = 1; id < size(); id++) {
+    const auto p = _parent[id];
+    _children[_first_child[p] + _child_count[p]++] = id;
+  }
+}
+
+void FlatLayout::updateItemGeometry(NodeId id)
+{
+  const auto& t = _transform[id];
+  const auto& c = _content_advance[id];
+  auto r = t.mapRect(_content[id]);
+  qreal ax = t.map(QLineF(0, 0, c.x(), 0)).dx();
+  qreal ay = t.map(QLineF(0, 0, 0, c.y())).dy();
+
+  if (_flags[id] & ResizeEnabled) {
+    const auto ks = _ks[id];
+    r = QRectF(r.topLeft() * ks, r.size() * ks);
+    ax *= ks;
+    ay *= ks;
+  }
+
+  _rect[id] = r;
+  _advance[id] = QPointF(ax, ay);
+}
+
+void FlatLayout::updateLayoutGeometry(NodeId id)
+{
+  const auto items = children(id);
+  QRectF r;
+  QPointF adv;
+
+  if (!items.empty()) {
+    FlatLayoutItems layout_items(*this, id);
+    const bool ignore_advance = _flags[id] & IgnoreAdvance;
+    const auto [ax, ay] = _orientation[id] == Qt::Vertical
+        ? LinearLayoutAlgorithm<Qt::Vertical, FlatLayoutItems>(layout_items, _spacing[id], ignore_advance).buildLayout()
+        : LinearLayoutAlgorithm<Qt::Horizontal, FlatLayoutItems>(layout_items, _spacing[id], ignore_advance).buildLayout();
+    adv = QPointF(ax, ay);
+    r = _rect[items.front()].translated(_pos[items.front()]);
+    for (auto i : items)
+      r |= _rect[i].translated(_pos[i]);
+  }
+
+  if (_flags[id] & HasLineMetrics) {
+    const auto [ascent, descent] = _line_metrics[id];
+    r.setTop(std::min(r.top(), -ascent));
+    r.setBottom(std::max(r.bottom(), descent));
+  }
+
+  _content[id] = r;
+  _content_advance[id] = adv;
+}
+
+QTransform FlatLayout::localTransform(NodeId id) const
+{
+  const auto& p = _pos[id];
+  return QTransform(_transform[id]).scale(_ks[id], _ks[id]) * QTransform::fromTranslate(p.x(), p.y());
+}
@@ -0,0 +1,143 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <QTransform>
+
+#include "resource.hpp"
+
+// layout tree stored as a set of flat arrays (one per node property),
+// nodes are referenced by their indices, and each node's children are
+// listed in a contiguous range, so geometry update and drawing are just
+// linear scans, and no per-node objects are allocated
+//
+// it is an alternative to LayoutItem-based trees intended for layouts
+// which are built as a whole, like skin-generated lines of glyphs,
+// only linear layouts (the same as LinearLayout) are supported
+//
+// the layout itself is a resource, it draws the root node's content
+class FlatLayout final : public Resource {
+public:
+  using NodeId = std::uint32_t;
+  static constexpr NodeId no_node = std::numeric_limits<NodeId>::max();
+
+  // all arrays use given memory resource, e.g. frame arena
+  explicit FlatLayout(std::pmr::memory_resource* mr = std::pmr::get_default_resource());
+
+  // preallocates memory for the given nodes count
+  void reserve(NodeId n);
+
+  // node is always added after its parent, so parents have smaller ids than
+  // their children, the first added node is the root, it must be a layout
+  // nodes are drawn in order they were added
+  NodeId addLayout(NodeId parent, Qt::Orientation o, qreal spacing = 0.0,
+                   bool ignore_advance = false);
+  NodeId addItem(NodeId parent, std::shared_ptr<Resource> res,
+                 QTransform t = QTransform());
+
+  NodeId size() const noexcept { return static_cast<NodeId>(_parent.size()); }
+
+  bool isLayout(NodeId id) const noexcept { return _flags[id] & IsLayout; }
+  NodeId parent(NodeId id) const noexcept { return _parent[id]; }
+  // valid only after updateGeometry()
+  std::span<const NodeId> children(NodeId id) const noexcept
+  {
+    return {_children.data() + _first_child[id], _child_count[id]};
+  }
+
+  // the same as LinearLayout::setItemAlignment() for the node's parent
+  void setAlignment(NodeId id, Qt::Alignment a) noexcept;
+  // node is resized in opposite direction of its parent, see LayoutItem::resize()
+  void setResizeEnabled(NodeId id, bool enabled) noexcept;
+  // node's content rect always covers [-ascent, descent] vertical range,
+  // it is used to keep line height regardless of its glyphs
+  void setLineMetrics(NodeId id, qreal ascent, qreal descent) noexcept;
+
+  // replaces item's resource, returns true if geometry has been changed,
+  // updateGeometry() must be called in this case
+  bool setResource(NodeId id, std::shared_ptr<Resource> res);
+
+  bool isGeometryDirty() const noexcept { return _geometry_dirty; }
+  // recalculates the whole tree, does nothing if it is not invalidated
+  void updateGeometry();
+
+  // node's own (not transformed) content rect
+  QRectF contentRect(NodeId id) const noexcept { return _content[id]; }
+  // maps node's content coordinates to the root's content coordinates
+  const QTransform& rootTransform(NodeId id) const noexcept { return _root_transform[id]; }
+  // node geometry in the root's content coordinates
+  QRectF geometryInRoot(NodeId id) const { return _root_transform[id].mapRect(_content[id]); }
+
+  // Resource interface, root's content
+  QRectF rect() const override;
+  qreal advanceX() const override;
+  qreal advanceY() const override;
+
+  void draw(QPainter* p) override;
+  bool record(DisplayListRecorder& r) const override;
+
+  // depends on resources of all items, their order and positions,
+  // it is cached until anything is changed
+  size_t cacheKey() const override;
+
+private:
+  enum NodeFlag : std::uint8_t {
+    IsLayout = 0x01,
+    IgnoreAdvance = 0x02,
+    ResizeEnabled = 0x04,
+    HasLineMetrics = 0x08,
+  };
+
+  NodeId addNode(NodeId parent, std::uint8_t flags);
+
+  void updateChildrenRanges();
+  void updateItemGeometry(NodeId id);
+  void updateLayoutGeometry(NodeId id);
+  QTransform localTransform(NodeId id) const;
+
+  friend class FlatLayoutItems;
+
+private:
+  // tree structure
+  std::pmr::vector<NodeId> _parent;
+  std::pmr::vector<NodeId> _first_child;   // index in _children
+  std::pmr::vector<NodeId> _child_count;
+  std::pmr::vector<NodeId> _children;      // children ids grouped by parent
+  std::pmr::vector<std::uint8_t> _flags;
+
+  // layout parameters (ignored for items)
+  std::pmr::vector<Qt::Orientation> _orientation;
+  std::pmr::vector<qreal> _spacing;
+  std::pmr::vector<std::pair<qreal, qreal>> _line_metrics;
+
+  // node parameters, as they are set by parent or user
+  std::pmr::vector<std::shared_ptr<Resource>> _res;    // only items have resources
+  std::pmr::vector<QTransform> _transform;
+  std::pmr::vector<Qt::Alignment> _alignment;
+  std::pmr::vector<QPointF> _pos;
+  std::pmr::vector<qreal> _ks;                         // resize scaling factor
+
+  // content geometry (resource geometry for items)
+  std::pmr::vector<QRectF> _content;
+  std::pmr::vector<QPointF> _content_advance;
+  // geometry in parent's coordinates (except position), see LayoutItem
+  std::pmr::vector<QRectF> _rect;
+  std::pmr::vector<QPointF> _advance;
+  std::pmr::vector<QTransform> _root_transform;
+
+  bool _geometry_dirty = false;
+  bool _structure_changed = false;
+  mutable std::optional<size_t> _cache_key;
+};
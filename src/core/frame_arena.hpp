@@ -0,0 +1,97 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+// monotonic memory arena for objects which are built and dropped together,
+// e.g. skin's frame (layout and its resources): objects are just placed one
+// after another in a preallocated buffer, nothing is freed individually
+//
+// objects created with makeShared() keep their arena alive, so they can be
+// passed anywhere, arena can be reset only if there are no such objects
+class FrameArena final {
+public:
+  static constexpr std::size_t initial_size = 16 * 1024;
+
+  FrameArena() noexcept
+    : _buffer(_initial.data(), _initial.size())
+  {}
+
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  std::pmr::memory_resource* resource() noexcept { return &_buffer; }
+
+  // makes all memory available again, the initial buffer is kept,
+  // there must be no alive objects allocated from the arena
+  void reset() noexcept { _buffer.release(); }
+
+private:
+  alignas(std::max_align_t) std::array<std::byte, initial_size> _initial;
+  std::pmr::monotonic_buffer_resource _buffer;
+};
+
+
+// allocator for std::allocate_shared(), it keeps the arena alive,
+// deallocation is no-op, so objects may be released in any thread
+template<typename T>
+class ArenaAllocator {
+public:
+  using value_type = T;
+
+  explicit ArenaAllocator(std::shared_ptr<FrameArena> arena) noexcept
+    : _arena(std::move(arena))
+  {}
+
+  template<typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+    : _arena(other.arena())
+  {}
+
+  T* allocate(std::size_t n)
+  {
+    return static_cast<T*>(_arena->resource()->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept
+  {
+    _arena->resource()->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  const std::shared_ptr<FrameArena>& arena() const noexcept { return _arena; }
+
+  template<typename U>
+  bool operator==(const ArenaAllocator<U>& other) const noexcept
+  {
+    return _arena == other.arena();
+  }
+
+private:
+  std::shared_ptr<FrameArena> _arena;
+};
+
+
+// std::make_shared() replacement, allocates object in the given arena,
+// falls back to std::make_shared() if there is no arena
+template<typename T, typename... Args>
+std::shared_ptr<T> makeShared(const std::shared_ptr<FrameArena>& arena, Args&&... args)
+{
+  if (!arena)
+    return std::make_shared<T>(std::forward<Args>(args)...);
+  return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+}
+
+// memory resource to use for containers of arena's objects
+inline std::pmr::memory_resource* memoryResource(const std::shared_ptr<FrameArena>& arena) noexcept
+{
+  return arena ? arena->resource() : std::pmr::get_default_resource();
+}
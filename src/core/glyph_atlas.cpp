@@ -0,0 +1,90 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "glyph_atlas.hpp"
+
+#include <QPainter>
+
+namespace {
+
+// to avoid bleeding of neighbours when scaled with smooth transform
+constexpr int padding = 1;
+
+} // namespace
+
+GlyphAtlas::Location GlyphAtlas::add(const QImage& img, bool allow_new_page)
+{
+  if (!fits(img.size()))
+    return {};
+
+  QRect r;
+  int idx = 0;
+  while (idx < pagesCount() && (isPageReleased(idx) || !allocate(_pages[idx], img.size(), &r)))
+    ++idx;
+
+  if (idx == pagesCount()) {
+    if (!allow_new_page || _allocated_pages >= _max_pages)
+      return {};
+    // reuse released slot if any
+    idx = 0;
+    while (idx < pagesCount() && !isPageReleased(idx))
+      ++idx;
+    if (idx == pagesCount())
+      _pages.emplace_back();
+    auto& page = _pages[idx];
+    page.img = QImage(_page_size, QImage::Format_ARGB32_Premultiplied);
+    page.img.fill(Qt::transparent);
+    ++_allocated_pages;
+    if (!allocate(page, img.size(), &r))
+      return {};
+  }
+
+  QPainter p(&_pages[idx].img);
+  p.setCompositionMode(QPainter::CompositionMode_Source);
+  p.drawImage(r, img, img.rect());
+  return {idx, r};
+}
+
+void GlyphAtlas::releasePage(int i)
+{
+  if (isPageReleased(i))
+    return;
+  _pages[i] = Page();
+  --_allocated_pages;
+}
+
+void GlyphAtlas::clear()
+{
+  _pages.clear();
+  _allocated_pages = 0;
+}
+
+bool GlyphAtlas::allocate(Page& page, QSize sz, QRect* r) const
+{
+  const int w = sz.width() + padding;
+  const int h = sz.height() + padding;
+
+  // the lowest suitable shelf, but not too high to waste space
+  Shelf* best = nullptr;
+  for (auto& shelf : page.shelves) {
+    if (shelf.height < h || shelf.height > h + h / 2 || shelf.x + w > _page_size.width())
+      continue;
+    if (!best || shelf.height < best->height)
+      best = &shelf;
+  }
+
+  if (!best) {
+    if (page.free_y + h > _page_size.height() || w > _page_size.width())
+      return false;
+    page.shelves.push_back({page.free_y, h});
+    page.free_y += h;
+    best = &page.shelves.back();
+  }
+
+  *r = QRect(QPoint(best->x, best->y), sz);
+  best->x += w;
+  return true;
+}
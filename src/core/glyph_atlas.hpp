@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <QImage>
+#include <QRect>
+
+/**
+ * @brief Few big images with many small images inside
+ *
+ * Simple shelf packing, there is no way to free a single item,
+ * only the whole page can be released (and reused later). It is fine
+ * for glyphs as any skin has only small fixed set of them.
+ */
+class GlyphAtlas final {
+public:
+  struct Location {
+    int page = -1;
+    QRect rect;   // in pixels
+
+    bool isValid() const noexcept { return page >= 0; }
+  };
+
+  explicit GlyphAtlas(QSize page_size = default_page_size, int max_pages = 1) noexcept
+    : _page_size(page_size)
+    , _max_pages(max_pages)
+  {}
+
+  // copies image into atlas, invalid location is returned if there is no space,
+  // new page is allocated only if allowed and pages limit is not reached
+  Location add(const QImage& img, bool allow_new_page = true);
+
+  bool fits(QSize sz) const noexcept
+  {
+    return sz.width() <= _page_size.width() && sz.height() <= _page_size.height();
+  }
+
+  const QImage& page(int i) const noexcept { return _pages[i].img; }
+  int pagesCount() const noexcept { return static_cast<int>(_pages.size()); }
+  // released pages keep their indices, so locations on other pages remain valid
+  void releasePage(int i);
+  bool isPageReleased(int i) const noexcept { return _pages[i].img.isNull(); }
+  // memory used by allocated (not released) pages
+  qsizetype bytes() const noexcept { return _allocated_pages * pageBytes(); }
+
+  void setMaxPages(int max_pages) noexcept { _max_pages = max_pages; }
+  qsizetype pageBytes() const noexcept { return qsizetype(_page_size.width()) * _page_size.height() * 4; }
+
+  void clear();
+
+  static constexpr QSize default_page_size = QSize(1024, 1024);
+
+private:
+  struct Shelf {
+    int y;
+    int height;
+    int x = 0;    // next free position
+  };
+
+  struct Page {
+    QImage img;
+    std::vector<Shelf> shelves;
+    int free_y = 0;
+  };
+
+  bool allocate(Page& page, QSize sz, QRect* r) const;
+
+private:
+  std::vector<Page> _pages;
+  QSize _page_size;
+  int _max_pages;
+  int _allocated_pages = 0;
+};
@@ -0,0 +1,173 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "glyph_cache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+
+namespace {
+
+std::atomic<quint64> g_generation = 0;
+
+qsizetype imageBytes(const QImage& img) noexcept
+{
+  return img.sizeInBytes();
+}
+
+} // namespace
+
+bool GlyphCache::find(const GlyphCacheKey& key, QImage* img)
+{
+  auto cached = get(key);
+  if (!cached)
+    return false;
+
+  if (cached.src == cached.img->rect()) {
+    *img = *cached.img;
+  } else {
+    *img = cached.img->copy(cached.src);
+    img->setDevicePixelRatio(key.dpr);
+  }
+  return true;
+}
+
+void GlyphCache::insert(const GlyphCacheKey& key, QImage img)
+{
+  put(key, std::move(img));
+}
+
+GlyphCache::Image GlyphCache::get(const GlyphCacheKey& key)
+{
+  checkGeneration();
+
+  auto iter = _index.constFind(key);
+  if (iter == _index.cend()) {
+    ++_stats.misses;
+    return {};
+  }
+
+  _lru.splice(_lru.begin(), _lru, *iter);
+  ++_stats.hits;
+  return image(_lru.front());
+}
+
+GlyphCache::Image GlyphCache::put(const GlyphCacheKey& key, QImage img)
+{
+  checkGeneration();
+
+  if (auto iter = _index.constFind(key); iter != _index.cend())
+    remove(*iter);
+
+  auto bytes = imageBytes(img);
+  if (bytes > _max_bytes)
+    return {};
+
+  // atlas pages are counted instead of their items, so
+  // atlas is used only if at least one page fits the budget
+  GlyphAtlas::Location loc;
+  if (_atlas_enabled && _atlas.pageBytes() <= _max_bytes && _atlas.fits(img.size())) {
+    loc = _atlas.add(img, false);
+    if (!loc.isValid()) {
+      evict(_atlas.pageBytes());
+      loc = _atlas.add(img);
+    }
+    if (loc.isValid()) {
+      img = QImage();
+      bytes = 0;
+    }
+  }
+
+  if (!loc.isValid())
+    evict(bytes);
+
+  _lru.push_front({key, std::move(img), loc, bytes});
+  _index.insert(key, _lru.begin());
+  _used_bytes += bytes;
+  return image(_lru.front());
+}
+
+void GlyphCache::clear()
+{
+  _index.clear();
+  _lru.clear();
+  _used_bytes = 0;
+  _atlas.clear();
+}
+
+void GlyphCache::setMaxBytes(qsizetype max_bytes)
+{
+  _max_bytes = max_bytes;
+  _atlas.setMaxPages(std::max<int>(1, _max_bytes / _atlas.pageBytes()));
+  evict(0);
+}
+
+void GlyphCache::setAtlasEnabled(bool enabled)
+{
+  if (_atlas_enabled == enabled)
+    return;
+  clear();
+  _atlas_enabled = enabled;
+  _atlas.setMaxPages(std::max<int>(1, _max_bytes / _atlas.pageBytes()));
+}
+
+void GlyphCache::clearAll() noexcept
+{
+  ++g_generation;
+}
+
+void GlyphCache::checkGeneration()
+{
+  const auto generation = g_generation.load(std::memory_order_relaxed);
+  if (_generation == generation)
+    return;
+  clear();
+  _generation = generation;
+}
+
+void GlyphCache::evict(qsizetype required_bytes)
+{
+  while (!_lru.empty() && usedBytes() + required_bytes > _max_bytes) {
+    auto iter = std::prev(_lru.end());
+    // single atlas item doesn't free any memory, so its whole page is released
+    if (iter->loc.isValid()) {
+      releaseAtlasPage(iter->loc.page);
+    } else {
+      remove(iter);
+      ++_stats.evictions;
+    }
+  }
+  // pages may remain after their items were replaced
+  if (_lru.empty() && usedBytes() + required_bytes > _max_bytes)
+    _atlas.clear();
+}
+
+void GlyphCache::remove(LRUList::iterator iter)
+{
+  _used_bytes -= iter->bytes;
+  _index.remove(iter->key);
+  _lru.erase(iter);
+}
+
+void GlyphCache::releaseAtlasPage(int page)
+{
+  for (auto iter = _lru.begin(); iter != _lru.end();) {
+    auto curr = iter++;
+    if (curr->loc.isValid() && curr->loc.page == page) {
+      remove(curr);
+      ++_stats.evictions;
+    }
+  }
+  _atlas.releasePage(page);
+}
+
+GlyphCache::Image GlyphCache::image(const Entry& e) const noexcept
+{
+  if (e.loc.isValid())
+    return {&_atlas.page(e.loc.page), e.loc.rect};
+  return {&e.img, e.img.rect()};
+}
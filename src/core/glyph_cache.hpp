@@ -0,0 +1,123 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <list>
+
+#include <QHash>
+#include <QImage>
+#include <QSize>
+
+#include "glyph_atlas.hpp"
+
+struct GlyphCacheKey {
+  size_t key = 0;     // Resource::cacheKey()
+  QSize size;         // size in device pixels
+  qreal dpr = 1.0;
+
+  friend bool operator==(const GlyphCacheKey&, const GlyphCacheKey&) noexcept = default;
+};
+
+inline size_t qHash(const GlyphCacheKey& k, size_t seed = 0) noexcept
+{
+  return qHashMulti(seed, k.key, k.size.width(), k.size.height(), k.dpr);
+}
+
+/**
+ * @brief Rendered glyphs cache
+ *
+ * Simple LRU cache with memory budget in bytes. Intended to be owned
+ * by a skin (or a window), so different skins don't evict each other's
+ * glyphs as it happens with process-global QPixmapCache.
+ * QImage is used for storage, so it can be used outside of GUI thread,
+ * but it is not thread-safe itself.
+ *
+ * Optionally items can be stored in atlas, in this case the budget
+ * includes atlas pages rather than items in them, and the page holding
+ * the least recently used item is released (with all its items) when
+ * more memory is required.
+ */
+class GlyphCache final {
+public:
+  struct Stats {
+    quint64 hits = 0;
+    quint64 misses = 0;
+    quint64 evictions = 0;
+  };
+
+  explicit GlyphCache(qsizetype max_bytes = default_limit) noexcept
+    : _max_bytes(max_bytes)
+  {}
+
+  GlyphCache(const GlyphCache&) = delete;
+  GlyphCache& operator=(const GlyphCache&) = delete;
+
+  // cached image, it is a part of some bigger image in case of atlas
+  struct Image {
+    const QImage* img = nullptr;
+    QRect src;    // in pixels
+
+    explicit operator bool() const noexcept { return img != nullptr; }
+  };
+
+  // on success moves found item to the front of LRU list
+  bool find(const GlyphCacheKey& key, QImage* img);
+  // item bigger than the whole budget is not inserted
+  void insert(const GlyphCacheKey& key, QImage img);
+
+  // the same as find()/insert(), but without copying atlas parts,
+  // returned value is valid until the next cache modification
+  Image get(const GlyphCacheKey& key);
+  Image put(const GlyphCacheKey& key, QImage img);
+
+  void clear();
+
+  void setAtlasEnabled(bool enabled);
+  bool atlasEnabled() const noexcept { return _atlas_enabled; }
+  const GlyphAtlas& atlas() const noexcept { return _atlas; }
+
+  void setMaxBytes(qsizetype max_bytes);
+  qsizetype maxBytes() const noexcept { return _max_bytes; }
+  // includes whole atlas pages
+  qsizetype usedBytes() const noexcept { return _used_bytes + _atlas.bytes(); }
+  qsizetype count() const noexcept { return _index.size(); }
+
+  const Stats& stats() const noexcept { return _stats; }
+  void resetStats() noexcept { _stats = {}; }
+
+  // invalidates all existing caches, e.g. on system theme change,
+  // each cache is actually cleared on its next access
+  static void clearAll() noexcept;
+
+  static constexpr qsizetype default_limit = 16 * 1024 * 1024;
+
+private:
+  struct Entry {
+    GlyphCacheKey key;
+    QImage img;                 // null if item is in atlas
+    GlyphAtlas::Location loc;
+    qsizetype bytes;            // 0 if item is in atlas
+  };
+
+  using LRUList = std::list<Entry>;
+
+  void checkGeneration();
+  void evict(qsizetype required_bytes);
+  void remove(LRUList::iterator iter);
+  void releaseAtlasPage(int page);
+  Image image(const Entry& e) const noexcept;
+
+private:
+  LRUList _lru;     // most recently used items are at the front
+  QHash<GlyphCacheKey, LRUList::iterator> _index;
+  qsizetype _max_bytes;
+  qsizetype _used_bytes = 0;   // standalone items only
+  quint64 _generation = 0;
+  Stats _stats;
+  GlyphAtlas _atlas;
+  bool _atlas_enabled = false;
+};
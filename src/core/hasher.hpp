@@ -6,18 +6,98 @@
 
 #pragma once
 
-#include <QByteArray>
-#include <QDataStream>
-#include <QIODevice>
+#include <cstdint>
+
+#include <QBrush>
+#include <QColor>
+#include <QHashFunctions>
+#include <QPointF>
+#include <QTransform>
+
+// order-sensitive combination of hash values, suitable for building
+// keys of sequences: combine(combine(s, a), b) != combine(combine(s, b), a)
+constexpr size_t hashCombine(size_t seed, size_t value) noexcept
+{
+  // splitmix64 finalizer over the boost::hash_combine-like mix
+  std::uint64_t x = static_cast<std::uint64_t>(seed) ^
+                    (static_cast<std::uint64_t>(value) + 0x9e3779b97f4a7c15ull +
+                     (static_cast<std::uint64_t>(seed) << 6) + (static_cast<std::uint64_t>(seed) >> 2));
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  x = x ^ (x >> 31);
+  return static_cast<size_t>(x);
+}
+
+// hash of a single value, fields are combined directly, nothing is
+// serialized or allocated, add an overload to support another type
+// (anything qHash() supports is supported out of the box)
+template<typename T>
+requires requires(const T& v) { qHash(v); }
+size_t hashValue(const T& v) noexcept(noexcept(qHash(v)))
+{
+  return qHash(v);
+}
+
+inline size_t hashValue(const QPointF& p) noexcept
+{
+  return qHashMulti(0, p.x(), p.y());
+}
+
+inline size_t hashValue(const QColor& c) noexcept
+{
+  return qHashMulti(0, c.spec(), static_cast<quint64>(c.rgba64()));
+}
+
+inline size_t hashValue(const QGradient& g) noexcept
+{
+  size_t h = qHashMulti(0, g.type(), g.spread(), g.coordinateMode(), g.interpolationMode());
+  for (const auto& [pos, color] : g.stops())
+    h = hashCombine(h, qHashMulti(0, pos, hashValue(color)));
+
+  switch (g.type()) {
+    case QGradient::LinearGradient: {
+      const auto& lg = static_cast<const QLinearGradient&>(g);
+      h = hashCombine(h, qHashMulti(0, hashValue(lg.start()), hashValue(lg.finalStop())));
+      break;
+    }
+    case QGradient::RadialGradient: {
+      const auto& rg = static_cast<const QRadialGradient&>(g);
+      h = hashCombine(h, qHashMulti(0, hashValue(rg.center()), rg.centerRadius(),
+                                    hashValue(rg.focalPoint()), rg.focalRadius()));
+      break;
+    }
+    case QGradient::ConicalGradient: {
+      const auto& cg = static_cast<const QConicalGradient&>(g);
+      h = hashCombine(h, qHashMulti(0, hashValue(cg.center()), cg.angle()));
+      break;
+    }
+    default:
+      break;
+  }
+  return h;
+}
+
+// textures are identified by image cache keys, pixels are not hashed,
+// so the same texture loaded twice gives different values (never the same
+// value for different textures, what matters for caching)
+// pixmap texture is converted to image only once, the image is shared
+// by all brush copies, so they have the same value, but brushes created
+// from the same pixmap separately do not, so hash the brush when it is
+// set and keep the value (as effects do), don't rebuild the brush
+inline size_t hashValue(const QBrush& b)
+{
+  size_t h = qHashMulti(0, b.style(), hashValue(b.color()), b.transform());
+  if (auto g = b.gradient())
+    h = hashCombine(h, hashValue(*g));
+  if (b.style() == Qt::TexturePattern)
+    h = hashCombine(h, b.textureImage().cacheKey());
+  return h;
+}
 
-// this hasher may be pretty heavy but yet flexible
-// as so as it uses serialization under the hood
-// use with caution, avoid recalculation if possible
 template<typename... T>
-size_t hasher(T&&... objs)
+size_t hasher(const T&... objs)
 {
-  QByteArray buffer;
-  QDataStream stream(&buffer, QIODevice::WriteOnly);
-  (stream << ... << objs);
-  return qHash(buffer);
+  size_t seed = 0;
+  ((seed = hashCombine(seed, hashValue(objs))), ...);
+  return seed;
 }
@@ -11,84 +11,73 @@
 
 #include <QPainter>
 
-#include "layout_debug.hpp"
+#include "display_list.hpp"
+#include "hasher.hpp"
 
 namespace {
 
-class DebugContext final {
-public:
-  explicit DebugContext(const char* env_var) noexcept
-    : _env_var(env_var)
-  {
-    Q_ASSERT(_env_var);
-  }
+thread_local std::size_t recalculated_items_count = 0;
 
-  bool operator&(debug::LayoutDebugFlag flag) const noexcept
-  {
-    auto raw_value = qEnvironmentVariableIntValue(_env_var);
-    return (static_cast<debug::LayoutDebug>(raw_value) & flag) != 0;
-  }
+} // namespace
 
-private:
-  const char* _env_var;
-};
+LayoutItem::LayoutItem(std::shared_ptr<Resource> res)
+  : _res(std::move(res))
+{
+  Q_ASSERT(_res);
+  updateCachedGeometry();
+}
 
-class DebugResource final : public ResourceDecorator {
-public:
-  static auto decorate(std::shared_ptr<Resource> res, DebugContext ctx)
-  {
-    // avoid double decoration, re-use the same debug resource
-    if (auto dres = std::dynamic_pointer_cast<DebugResource>(res))
-      return dres;
+void LayoutItem::invalidateGeometry() noexcept
+{
+  _geometry_dirty = true;
+  // dirty item always has dirty parents, so stop at the first one
+  for (auto p = parent(); p && !p->_geometry_dirty; p = p->parent())
+    p->_geometry_dirty = true;
+}
 
-    return std::make_shared<DebugResource>(std::move(res), std::move(ctx));
-  }
+void LayoutItem::invalidateContent() noexcept
+{
+  // intermediate items may be not interested, but their parents may be
+  for (auto p = parent(); p; p = p->parent())
+    p->childContentChanged();
+}
 
-  DebugResource(std::shared_ptr<Resource> res, DebugContext ctx) noexcept
-    : ResourceDecorator(std::move(res))
-    , _ctx(std::move(ctx))
-  {}
+void LayoutItem::updateGeometry()
+{
+  invalidateGeometry();
+  updateDirtyGeometry();
 
-  void draw(QPainter* p) override
-  {
-    ResourceDecorator::draw(p);
+  // each parent recalculates only its invalidated children,
+  // this item (and the previous parent) is already up to date
+  for (auto p = parent(); p; p = p->parent())
+    p->updateDirtyGeometry();
+}
 
-    DEBUG_DRAW(debug::DrawOriginalRect, _ctx, p, Rect, rect());
-    DEBUG_DRAW(debug::DrawOriginPoint, _ctx, p, Ellipse, QPoint(0, 0), 2, 2);
-    DEBUG_DRAW(debug::DrawHBaseline, _ctx, p, Line, rect().left(), 0, rect().right(), 0);
-    DEBUG_DRAW(debug::DrawVBaseline, _ctx, p, Line, 0, rect().top(), 0, rect().bottom());
-  }
+void LayoutItem::updateDirtyGeometry()
+{
+  if (!_geometry_dirty) return;
 
-private:
-  DebugContext _ctx;
-};
+  updateChildrenGeometry();   // bottom-up
+  doUpdateGeometry();
+  updateCachedGeometry();
 
-auto item_context() noexcept
-{
-  return DebugContext(debug::ItemDebugFlagsVar);
+  _geometry_dirty = false;
+  ++recalculated_items_count;
 }
 
-auto layout_context() noexcept
+std::size_t LayoutItem::recalculatedItemsCount() noexcept
 {
-  return DebugContext(debug::LayoutDebugFlagsVar);
+  return recalculated_items_count;
 }
 
-} // namespace
-
-LayoutItem::LayoutItem(std::shared_ptr<Resource> res)
-  : _res(DebugResource::decorate(std::move(res), item_context()))
+void LayoutItem::resetRecalculatedItemsCount() noexcept
 {
-  Q_ASSERT(_res);
-  updateCachedGeometry();
+  recalculated_items_count = 0;
 }
 
-void LayoutItem::updateGeometry()
+void LayoutItem::countRecalculatedItems(std::size_t n) noexcept
 {
-  doUpdateGeometry();
-  updateCachedGeometry();
-
-  if (auto parent = _parent.lock())
-    parent->updateGeometry();
+  recalculated_items_count += n;
 }
 
 void LayoutItem::setResizeEnabled(bool enabled)
@@ -126,12 +115,18 @@ Layout::Layout() : Layout(std::make_shared<Layout::LayoutResource>())
 }
 
 Layout::Layout(std::shared_ptr<LayoutResource> res)
-  : LayoutItem(DebugResource::decorate(res, layout_context()))
+  : LayoutItem(res)
   , _res(std::move(res))
 {
   Q_ASSERT(_res);
 }
 
+void Layout::visitChildren(const ChildVisitor& visitor) const
+{
+  for (const auto& item : _res->items())
+    visitor(*item, item->transform() * QTransform::fromTranslate(item->pos().x(), item->pos().y()));
+}
+
 void Layout::LayoutResource::draw(QPainter* p)
 {
   for (const auto& item : _items) {
@@ -143,18 +138,31 @@ void Layout::LayoutResource::draw(QPainter* p)
   }
 }
 
+bool Layout::LayoutResource::record(DisplayListRecorder& r) const
+{
+  for (const auto& item : _items)
+    r.add(item->resource(), item->transform() * QTransform::fromTranslate(item->pos().x(), item->pos().y()));
+  return true;
+}
+
 size_t Layout::LayoutResource::cacheKey() const
 {
-  return std::transform_reduce(
-        _items.begin(), _items.end(),
-        static_cast<size_t>(0),
-        std::bit_xor{},
-        [](const auto& item) { return item->resource()->cacheKey(); }
-  );
+  if (!_cache_key) {
+    size_t key = _items.size();
+    for (const auto& item : _items) {
+      key = hashCombine(key, item->resource()->cacheKey());
+      key = hashCombine(key, qHashMulti(0, item->pos().x(), item->pos().y(), item->transform()));
+    }
+    _cache_key = key;
+  }
+  return *_cache_key;
 }
 
 void Layout::LayoutResource::updateGeometry(qreal ax, qreal ay)
 {
+  // items positions may be changed
+  invalidateCacheKey();
+
   if (_items.empty()) return;
 
   _rect = std::transform_reduce(
@@ -198,6 +206,12 @@ void PlaceholderItem::doUpdateGeometry()
   item->setPos(item->pos() + QPointF(dx, dy));
 }
 
+void PlaceholderItem::visitChildren(const ChildVisitor& visitor) const
+{
+  if (const auto& item = _res->content())
+    visitor(*item, item->transform() * QTransform::fromTranslate(item->pos().x(), item->pos().y()));
+}
+
 void PlaceholderItem::PlaceholderResource::draw(QPainter* p)
 {
   if (!_item) return;
@@ -208,3 +222,10 @@ void PlaceholderItem::PlaceholderResource::draw(QPainter* p)
   _item->resource()->draw(p);
   p->restore();
 }
+
+bool PlaceholderItem::PlaceholderResource::record(DisplayListRecorder& r) const
+{
+  if (_item)
+    r.add(_item->resource(), _item->transform() * QTransform::fromTranslate(_item->pos().x(), _item->pos().y()));
+  return true;
+}
@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include <QTransform>
@@ -52,8 +54,27 @@ public:
   std::shared_ptr<LayoutItem> parent() const { return _parent.lock(); }
   void setParent(std::weak_ptr<LayoutItem> p) { _parent = std::move(p); }
 
+  // only marks item and its parents as "dirty",
+  // nothing is recalculated until updateGeometry() is called
+  void invalidateGeometry() noexcept;
+  bool isGeometryDirty() const noexcept { return _geometry_dirty; }
+
+  // recalculates geometry of all invalidated items in this subtree,
+  // then walks up to the root recalculating each parent only once,
+  // items that were not invalidated are skipped
   void updateGeometry();
 
+  // the same as updateGeometry(), but doesn't touch parents
+  // and does nothing if item was not invalidated
+  void updateDirtyGeometry();
+
+  // diagnostics: count of items whose geometry has been recalculated
+  // (in the current thread) since the last reset, e.g. per frame
+  static std::size_t recalculatedItemsCount() noexcept;
+  static void resetRecalculatedItemsCount() noexcept;
+  // for other layout implementations, e.g. FlatLayout counts its nodes
+  static void countRecalculatedItems(std::size_t n) noexcept;
+
   // layout stuff
   bool resizeEnabled() const { return _resize_enabled; }
   void setResizeEnabled(bool enabled);
@@ -69,10 +90,24 @@ public:
   {
     _res = effect->decorate(std::move(_res));
     updateCachedGeometry();
+    invalidateContent();
   }
 
+  // should be called when resource content (but not geometry) is changed,
+  // e.g. glyph was replaced, invalidates cached data of all parents
+  void invalidateContent() noexcept;
+
+  // calls visitor for each direct child with its transform (to this item's
+  // coordinates), used by optional passes over the tree, e.g. debug drawing
+  using ChildVisitor = std::function<void(const LayoutItem&, const QTransform&)>;
+  virtual void visitChildren(const ChildVisitor& visitor) const { Q_UNUSED(visitor); }
+
 protected:
   virtual void doUpdateGeometry() {}
+  // should call updateDirtyGeometry() for each owned item
+  virtual void updateChildrenGeometry() {}
+  // some child's content has been changed, see invalidateContent()
+  virtual void childContentChanged() noexcept {}
 
 private:
   void updateCachedGeometry();
@@ -91,6 +126,8 @@ private:
   bool _resize_enabled = false;
   // scaling coefficient to achive "resize effect"
   qreal _ks = 1.0;
+  // geometry must be recalculated
+  bool _geometry_dirty = false;
 };
 
 
@@ -103,10 +140,13 @@ public:
     item->setParent(weak_from_this());
     doAddItem(item);
     _res->addItem(std::move(item));
+    invalidateGeometry();
   }
 
   const auto& items() const noexcept { return _res->items(); }
 
+  void visitChildren(const ChildVisitor& visitor) const override;
+
 protected:
   Layout();
 
@@ -117,6 +157,17 @@ protected:
     _res->updateGeometry(ax, ay);
   }
 
+  void updateChildrenGeometry() final
+  {
+    for (const auto& item : _res->items())
+      item->updateDirtyGeometry();
+  }
+
+  void childContentChanged() noexcept final
+  {
+    _res->invalidateCacheKey();
+  }
+
   virtual void doAddItem(std::shared_ptr<LayoutItem> item) = 0;
   // returns (ax,ay)
   virtual std::pair<qreal, qreal> doBuildLayout() = 0;
@@ -131,12 +182,17 @@ private:
     qreal advanceY() const override { return _ay; }
 
     void draw(QPainter* p) override;
+    bool record(DisplayListRecorder& r) const override;
 
+    // depends on items order, their positions and transforms,
+    // it is cached until items or their geometry is changed
     size_t cacheKey() const override;
+    void invalidateCacheKey() noexcept { _cache_key.reset(); }
 
     void addItem(std::shared_ptr<LayoutItem> item)
     {
       _items.push_back(std::move(item));
+      invalidateCacheKey();
     }
 
     using Items = std::vector<std::shared_ptr<LayoutItem>>;
@@ -153,6 +209,8 @@ private:
     QRectF _rect;
     qreal _ax = 0;
     qreal _ay = 0;
+
+    mutable std::optional<size_t> _cache_key;
   };
 
   Layout(std::shared_ptr<LayoutResource> res);
@@ -176,13 +234,22 @@ public:
     if (item)
       item->setParent(weak_from_this());
     _res->setContent(std::move(item));
+    invalidateGeometry();
   }
 
   void setContentAlignment(Qt::Alignment a) noexcept { _alignment = a; }
 
+  void visitChildren(const ChildVisitor& visitor) const override;
+
 protected:
   void doUpdateGeometry() override;
 
+  void updateChildrenGeometry() final
+  {
+    if (auto item = _res->content())
+      item->updateDirtyGeometry();
+  }
+
 private:
   // integral part of implementation
   // should not be a part of public API
@@ -199,6 +266,7 @@ private:
     qreal advanceY() const noexcept override { return _ay; }
 
     void draw(QPainter* p) override;
+    bool record(DisplayListRecorder& r) const override;
 
     size_t cacheKey() const noexcept override { return -1; }
 
@@ -6,10 +6,23 @@
 
 #include "layout_debug.hpp"
 
+#ifndef DISABLE_LAYOUT_DEBUG
+
+#include <atomic>
+
 #include <QPainter>
 
+#include "flat_layout.hpp"
+#include "layout.hpp"
+
 namespace debug {
 
+namespace {
+
+// set from GUI thread, read by any thread drawing
+std::atomic<int> item_debug_flags = 0;
+std::atomic<int> layout_debug_flags = 0;
+
 QPen configurePen(LayoutDebugFlag f)
 {
   QPen p(Qt::black, 2.0);
@@ -57,17 +70,122 @@ QBrush configureBrush(LayoutDebugFlag f)
   return b;
 }
 
-PainterSetup::PainterSetup(QPainter* p, LayoutDebugFlag f)
-  : _p(*p)
+class PainterSetup {
+public:
+  PainterSetup(QPainter* p, LayoutDebugFlag f)
+    : _p(*p)
+  {
+    _p.save();
+    _p.setPen(configurePen(f));
+    _p.setBrush(configureBrush(f));
+  }
+
+  ~PainterSetup()
+  {
+    _p.restore();
+  }
+
+private:
+  QPainter& _p;
+};
+
+#define DEBUG_DRAW(flag, flags, painter, shape, ...)  \
+  if (flags & flag) {                                 \
+    PainterSetup _(painter, flag);                    \
+    painter->draw##shape(__VA_ARGS__);                \
+  }
+
+// decorations of the single item, in item's resource coordinates
+void drawItemDebug(QPainter* p, const QRectF& r, LayoutDebug flags)
 {
-  _p.save();
-  _p.setPen(configurePen(f));
-  _p.setBrush(configureBrush(f));
+  DEBUG_DRAW(DrawOriginalRect, flags, p, Rect, r);
+  DEBUG_DRAW(DrawOriginPoint, flags, p, Ellipse, QPoint(0, 0), 2, 2);
+  DEBUG_DRAW(DrawHBaseline, flags, p, Line, r.left(), 0, r.right(), 0);
+  DEBUG_DRAW(DrawVBaseline, flags, p, Line, 0, r.top(), 0, r.bottom());
 }
 
-PainterSetup::~PainterSetup()
+#undef DEBUG_DRAW
+
+template<typename Root>
+class DebugOverlay final : public ResourceDecorator {
+public:
+  DebugOverlay(std::shared_ptr<Resource> res, std::shared_ptr<const Root> root) noexcept
+    : ResourceDecorator(std::move(res))
+    , _root(std::move(root))
+  {}
+
+  void draw(QPainter* p) override
+  {
+    ResourceDecorator::draw(p);
+    drawLayoutDebug(p, *_root);
+  }
+
+private:
+  std::shared_ptr<const Root> _root;
+};
+
+template<typename Root>
+std::shared_ptr<Resource> decorateWith(std::shared_ptr<Resource> res,
+                                       std::shared_ptr<const Root> root)
 {
-  _p.restore();
+  if (!isLayoutDebugEnabled() || !res || !root)
+    return res;
+  return std::make_shared<DebugOverlay<Root>>(std::move(res), std::move(root));
+}
+
+} // namespace
+
+void setLayoutDebugFlags(LayoutDebug item_flags, LayoutDebug layout_flags) noexcept
+{
+  item_debug_flags = item_flags.toInt();
+  layout_debug_flags = layout_flags.toInt();
+}
+
+bool isLayoutDebugEnabled() noexcept
+{
+  return item_debug_flags != 0 || layout_debug_flags != 0;
+}
+
+void drawLayoutDebug(QPainter* p, const LayoutItem& root)
+{
+  // children are drawn first, as decorations were drawn after content
+  root.visitChildren([p](const LayoutItem& child, const QTransform& t) {
+    p->save();
+    p->setTransform(t, true);
+    drawLayoutDebug(p, child);
+    p->restore();
+  });
+
+  const bool is_layout = dynamic_cast<const Layout*>(&root) != nullptr;
+  const auto flags = LayoutDebug::fromInt(is_layout ? layout_debug_flags : item_debug_flags);
+  drawItemDebug(p, root.resource()->rect(), flags);
+}
+
+void drawLayoutDebug(QPainter* p, const FlatLayout& root)
+{
+  const auto item_flags = LayoutDebug::fromInt(item_debug_flags);
+  const auto layout_flags = LayoutDebug::fromInt(layout_debug_flags);
+  const auto base = p->transform();
+  // children have greater ids, so they are drawn before their parents
+  for (auto id = root.size(); id-- > 0;) {
+    p->setTransform(root.rootTransform(id) * base);
+    drawItemDebug(p, root.contentRect(id), root.isLayout(id) ? layout_flags : item_flags);
+  }
+  p->setTransform(base);
+}
+
+std::shared_ptr<Resource> decorate(std::shared_ptr<Resource> res,
+                                   std::shared_ptr<const LayoutItem> root)
+{
+  return decorateWith(std::move(res), std::move(root));
+}
+
+std::shared_ptr<Resource> decorate(std::shared_ptr<Resource> res,
+                                   std::shared_ptr<const FlatLayout> root)
+{
+  return decorateWith(std::move(res), std::move(root));
 }
 
 } // namespace debug
+
+#endif
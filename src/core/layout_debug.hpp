@@ -6,9 +6,14 @@
 
 #pragma once
 
+#include <memory>
+
 #include <QFlags>
 
 class QPainter;
+class FlatLayout;
+class LayoutItem;
+class Resource;
 
 namespace debug {
 
@@ -24,24 +29,47 @@ enum LayoutDebugFlag {
 Q_DECLARE_FLAGS(LayoutDebug, LayoutDebugFlag)
 Q_DECLARE_OPERATORS_FOR_FLAGS(LayoutDebug)
 
-class PainterSetup {
-public:
-  PainterSetup(QPainter* p, LayoutDebugFlag f);
-  ~PainterSetup();
+// debug drawing is a separate pass over the layout tree, it is done
+// only when any flag is set, normal drawing doesn't depend on it at all
+// it can be compiled out completely (DISABLE_LAYOUT_DEBUG)
+#ifndef DISABLE_LAYOUT_DEBUG
 
-private:
-  QPainter& _p;
-};
+void setLayoutDebugFlags(LayoutDebug item_flags, LayoutDebug layout_flags) noexcept;
+bool isLayoutDebugEnabled() noexcept;
 
-static constexpr const char* const ItemDebugFlagsVar =
-    "DIGITAL_CLOCK_NEXT_DEBUG_ITEM_FLAGS";
-static constexpr const char* const LayoutDebugFlagsVar =
-    "DIGITAL_CLOCK_NEXT_DEBUG_LAYOUT_FLAGS";
+// draws debug decorations of the whole tree, painter must be
+// set up to the coordinate system of the given root item
+void drawLayoutDebug(QPainter* p, const LayoutItem& root);
+// the same for flat layout, painter is set up to its content coordinates
+void drawLayoutDebug(QPainter* p, const FlatLayout& root);
 
-} // namespace debug
+// returns resource that draws layout decorations over the given one
+// if debug drawing is enabled, otherwise returns given resource as is
+std::shared_ptr<Resource> decorate(std::shared_ptr<Resource> res,
+                                   std::shared_ptr<const LayoutItem> root);
+std::shared_ptr<Resource> decorate(std::shared_ptr<Resource> res,
+                                   std::shared_ptr<const FlatLayout> root);
+
+#else
+
+inline void setLayoutDebugFlags(LayoutDebug, LayoutDebug) noexcept {}
+constexpr bool isLayoutDebugEnabled() noexcept { return false; }
 
-#define DEBUG_DRAW(flag, flags, painter, shape, ...)  \
-  if (flags & flag) {                                 \
-    debug::PainterSetup _(painter, flag);             \
-    painter->draw##shape(__VA_ARGS__);                \
-  }
+inline void drawLayoutDebug(QPainter*, const LayoutItem&) {}
+inline void drawLayoutDebug(QPainter*, const FlatLayout&) {}
+
+inline std::shared_ptr<Resource> decorate(std::shared_ptr<Resource> res,
+                                          std::shared_ptr<const LayoutItem>)
+{
+  return res;
+}
+
+inline std::shared_ptr<Resource> decorate(std::shared_ptr<Resource> res,
+                                          std::shared_ptr<const FlatLayout>)
+{
+  return res;
+}
+
+#endif
+
+} // namespace debug
@@ -0,0 +1,201 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <utility>
+
+#include <QRectF>
+
+// linear layout algorithm shared by LinearLayout and FlatLayout,
+// specialized for each orientation, so coordinates access is resolved
+// at compile time, and for each items storage, which is accessed only
+// through items accessor A (items are referenced by their index in layout):
+//   std::size_t size() const
+//   QRectF rect(std::size_t i) const
+//   QPointF pos(std::size_t i) const
+//   void setPos(std::size_t i, QPointF p)
+//   qreal ax(std::size_t i) const
+//   qreal ay(std::size_t i) const
+//   bool resizeEnabled(std::size_t i) const
+//   Qt::Alignment alignment(std::size_t i) const
+//   void resize(std::size_t i, qreal l, Qt::Orientation o)
+template<Qt::Orientation O, typename A>
+class LinearLayoutAlgorithm {
+  static constexpr bool horizontal = O == Qt::Horizontal;
+  static constexpr Qt::Orientation opposite = horizontal ? Qt::Vertical : Qt::Horizontal;
+
+public:
+  LinearLayoutAlgorithm(A& items, qreal spacing, bool ignore_advance) noexcept
+    : _items(items)
+    , _spacing(spacing)
+    , _ignore_advance(ignore_advance)
+  {}
+
+  // returns layout's advance values (ax, ay)
+  std::pair<qreal, qreal> buildLayout()
+  {
+    Q_ASSERT(_items.size() > 0);
+    resetPosInOppositeDirection();
+    const auto [min_c, max_c] = resizeItems();
+    // position items
+    applyAlignment(0, min_c, max_c);
+
+    for (std::size_t i = 1; i < _items.size(); i++) {
+      applyAlignment(i, min_c, max_c);
+      // positioning
+      qreal dpos = cpos(_items.pos(i - 1));
+      if (_ignore_advance) {
+        dpos += cmax(_items.rect(i - 1));
+        dpos -= cmin(_items.rect(i));
+      } else {
+        dpos += horizontal ? _items.ax(i - 1) : _items.ay(i);
+      }
+      auto pos = _items.pos(i);
+      cpos(pos) = dpos + _spacing;
+      _items.setPos(i, std::move(pos));
+    }
+
+    return advances();
+  }
+
+private:
+  // min/max coordinates in the same direction
+  static qreal cmin(const QRectF& r) noexcept { return horizontal ? r.left() : r.top(); }
+  static qreal cmax(const QRectF& r) noexcept { return horizontal ? r.right() : r.bottom(); }
+  // min/max coordinates in opposite direction
+  static qreal omin(const QRectF& r) noexcept { return horizontal ? r.top() : r.left(); }
+  static qreal omax(const QRectF& r) noexcept { return horizontal ? r.bottom() : r.right(); }
+
+  // coordinate in the same direction
+  static qreal cpos(const QPointF& p) noexcept { return horizontal ? p.x() : p.y(); }
+  static qreal& cpos(QPointF& p) noexcept { return horizontal ? p.rx() : p.ry(); }
+  // coordinate in opposite direction
+  static qreal& opos(QPointF& p) noexcept { return horizontal ? p.ry() : p.rx(); }
+
+  // current item geometry based on min/max values
+  static QRectF geometry(const QRectF& r, qreal min_c, qreal max_c) noexcept
+  {
+    if constexpr (horizontal)
+      return QRectF(r.x(), min_c, r.width(), max_c - min_c);
+    else
+      return QRectF(min_c, r.y(), max_c - min_c, r.height());
+  }
+
+  // set coordinate to 0 for opposite direction
+  // required for correctly changing layout on run-time
+  void resetPosInOppositeDirection()
+  {
+    for (std::size_t i = 0; i < _items.size(); i++) {
+      auto pos = _items.pos(i);
+      opos(pos) = 0;
+      _items.setPos(i, std::move(pos));
+    }
+  }
+
+  // items are resized only in the opposite direction
+  // (e.g. in vertical direction for horizontal layout),
+  // item itself decides how to handle resize
+  // returns min/max coordinates (in opposite direction)
+  std::pair<qreal, qreal> resizeItems()
+  {
+    // find min/max y for non-resizeable items
+    std::size_t f_item = 0;
+    while (f_item < _items.size() && _items.resizeEnabled(f_item)) f_item++;
+    if (f_item == _items.size()) f_item = 0;
+
+    qreal min_c = omin(_items.rect(f_item));
+    qreal max_c = omax(_items.rect(f_item));
+
+    bool has_resizeable = false;
+    for (std::size_t i = 0; i < _items.size(); i++) {
+      if (_items.resizeEnabled(i)) {
+        has_resizeable = true;
+        continue;
+      }
+      const auto r = _items.rect(i);
+      min_c = std::min(min_c, omin(r));
+      max_c = std::max(max_c, omax(r));
+    }
+
+    if (!has_resizeable)
+      return {min_c, max_c};
+
+    // resize resizeable items
+    for (std::size_t i = 0; i < _items.size(); i++) {
+      if (!_items.resizeEnabled(i)) continue;
+      _items.resize(i, max_c - min_c, opposite);
+      auto pos = _items.pos(i);
+      opos(pos) = min_c - omin(_items.rect(i));
+      _items.setPos(i, std::move(pos));
+    }
+
+    return {min_c, max_c};
+  }
+
+  // constructs item's geometry using min/max coordinates
+  // (in opposite direction) and applies alignment to the item at index i
+  void applyAlignment(std::size_t i, qreal min_c, qreal max_c)
+  {
+    // alignment can be applied only to non-resizeable items
+    if (_items.resizeEnabled(i)) return;
+
+    const auto r = _items.rect(i);
+    const auto g = geometry(r, min_c, max_c);
+    const auto a = _items.alignment(i);
+    auto halign = a & Qt::AlignHorizontal_Mask;
+    auto valign = a & Qt::AlignVertical_Mask;
+    qreal dx = 0;
+    qreal dy = 0;
+    if (halign == Qt::AlignLeft) dx = g.left() - r.left();
+    if (halign == Qt::AlignHCenter) dx = g.center().x() - r.center().x();
+    if (halign == Qt::AlignRight) dx = g.right() - r.right();
+    if (valign == Qt::AlignTop) dy = g.top() - r.top();
+    if (valign == Qt::AlignVCenter) dy = g.center().y() - r.center().y();
+    if (valign == Qt::AlignBottom) dy = g.bottom() - r.bottom();
+
+    _items.setPos(i, _items.pos(i) + QPointF(dx, dy));
+  }
+
+  // calculates layout's advance values (ax, ay)
+  std::pair<qreal, qreal> advances() const
+  {
+    const std::size_t front = 0;
+    const std::size_t back = _items.size() - 1;
+
+    if constexpr (horizontal) {
+      qreal max_y_this_line = _items.pos(front).y();
+      qreal min_y_prev_line = max_y_this_line - _items.ay(front);
+
+      for (std::size_t i = 0; i < _items.size(); i++) {
+        const auto y = _items.pos(i).y();
+        max_y_this_line = std::max(max_y_this_line, y);
+        min_y_prev_line = std::min(min_y_prev_line, y - _items.ay(i));
+      }
+
+      qreal ax = _items.pos(back).x() - _items.pos(front).x() + _items.ax(back);
+      return {ax, max_y_this_line - min_y_prev_line};
+    } else {
+      qreal min_x_this_line = _items.pos(front).x();
+      qreal max_x_next_line = min_x_this_line + _items.ax(front);
+
+      for (std::size_t i = 0; i < _items.size(); i++) {
+        const auto x = _items.pos(i).x();
+        min_x_this_line = std::min(min_x_this_line, x);
+        max_x_next_line = std::max(max_x_next_line, x + _items.ax(i));
+      }
+
+      qreal ay = _items.pos(back).y() - _items.pos(front).y() + _items.ay(front);
+      return {max_x_next_line - min_x_this_line, ay};
+    }
+  }
+
+private:
+  A& _items;
+  const qreal _spacing;
+  const bool _ignore_advance;
+};
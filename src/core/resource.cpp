@@ -7,7 +7,8 @@
 #include "resource.hpp"
 
 #include <QPainter>
-#include <QPixmapCache>
+
+#include "glyph_cache.hpp"
 
 void CachedResource::draw(QPainter* p)
 {
@@ -17,19 +18,18 @@ void CachedResource::draw(QPainter* p)
   p->save();
   auto ext_tr = p->transform();
   auto br = p->transform().mapRect(rect());
-  auto sz = (br.size() * p->device()->devicePixelRatioF()).toSize();
+  const auto dpr = p->device()->devicePixelRatioF();
+  auto sz = (br.size() * dpr).toSize();
 
-  QString key = QString("%1_%2x%3")
-                .arg(cacheKey())
-                .arg(sz.width()).arg(sz.height());
-  QPixmap pxm;
+  const GlyphCacheKey key{cacheKey(), sz, dpr};
+  auto img = _cache->get(key);
 
-  if (!QPixmapCache::find(key, &pxm)) {
-    pxm = QPixmap(sz);
-    pxm.setDevicePixelRatio(p->device()->devicePixelRatioF());
-    pxm.fill(Qt::transparent);
+  if (!img) {
+    QImage buffer(sz, QImage::Format_ARGB32_Premultiplied);
+    buffer.setDevicePixelRatio(dpr);
+    buffer.fill(Qt::transparent);
     {
-      QPainter pp(&pxm);
+      QPainter pp(&buffer);
       pp.setBrush(p->brush());
       pp.setPen(p->pen());
       pp.setRenderHints(p->renderHints());
@@ -37,10 +37,19 @@ void CachedResource::draw(QPainter* p)
       pp.setTransform(ext_tr, true);
       ResourceDecorator::draw(&pp);
     }
-    QPixmapCache::insert(key, pxm);
+    img = _cache->put(key, buffer);
+    // not cached for some reason, just draw what we have
+    if (!img) {
+      p->resetTransform();
+      p->translate(br.topLeft());
+      p->drawImage(0, 0, buffer);
+      p->restore();
+      return;
+    }
   }
   p->resetTransform();
   p->translate(br.topLeft());
-  p->drawPixmap(0, 0, pxm);
+  // image may be a part of the atlas, so source rect is in pixels
+  p->drawImage(QRectF(QPointF(0, 0), QSizeF(img.src.size()) / dpr), *img.img, QRectF(img.src));
   p->restore();
 }
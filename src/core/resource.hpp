@@ -10,6 +10,8 @@
 
 #include <QRect>
 
+class DisplayListRecorder;
+class GlyphCache;
 class QPainter;
 
 // "skin resource"
@@ -28,6 +30,15 @@ public:
   virtual void draw(QPainter* p) = 0;
 
   virtual size_t cacheKey() const = 0;
+
+  // flattens drawing into display list: composite resource should add
+  // all its parts to the recorder and return true, by default resource
+  // is drawn as a whole (false is returned), see DisplayList
+  virtual bool record(DisplayListRecorder& r) const
+  {
+    Q_UNUSED(r);
+    return false;
+  }
 };
 
 
@@ -50,11 +61,18 @@ private:
 };
 
 
+// rendered result is stored in given cache
 class CachedResource : public ResourceDecorator {
 public:
-  using ResourceDecorator::ResourceDecorator;
+  CachedResource(std::shared_ptr<Resource> r, std::shared_ptr<GlyphCache> cache) noexcept
+    : ResourceDecorator(std::move(r))
+    , _cache(std::move(cache))
+  {}
 
   void draw(QPainter* p) override;
+
+private:
+  std::shared_ptr<GlyphCache> _cache;
 };
 
 
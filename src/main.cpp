@@ -7,23 +7,30 @@
 #include <QIcon>
 
 #include "app/application.hpp"
+#include "app/headless_renderer.hpp"
 #include "version.hpp"
 
 int main(int argc, char *argv[])
 {
+  using namespace Qt::Literals::StringLiterals;
+  // application info is required in any mode (e.g. for skins search paths)
+  QCoreApplication::setApplicationName(QString::fromLatin1(APP_PROJECT_NAME));
+  QCoreApplication::setApplicationVersion(QString::fromLatin1(APP_VERSION));
+  QCoreApplication::setOrganizationName(u"NickKorotysh"_s);
+  QCoreApplication::setOrganizationDomain(u"kolcha.github.com"_s);
+
+  // no windows, no tray icon, no settings - only rendering
+  if (isHeadlessMode(argc, argv))
+    return runHeadless(argc, argv);
+
   Application a(argc, argv);
 
-  using namespace Qt::Literals::StringLiterals;
   // set system icon theme as fallback
   auto system_theme = QIcon::themeName();
   QIcon::setThemeName(u"unicons-line"_s);
   QIcon::setFallbackThemeName(system_theme);
 
-  QApplication::setApplicationName(QString::fromLatin1(APP_PROJECT_NAME));
   QApplication::setApplicationDisplayName(u"Digital Clock Next"_s);
-  QApplication::setApplicationVersion(QString::fromLatin1(APP_VERSION));
-  QApplication::setOrganizationName(u"NickKorotysh"_s);
-  QApplication::setOrganizationDomain(u"kolcha.github.com"_s);
   QApplication::setDesktopFileName(APP_IDENTIFIER);
   QApplication::setWindowIcon(QIcon::fromTheme("clock"));
 #ifdef Q_OS_MACOS
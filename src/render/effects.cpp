@@ -6,24 +6,205 @@
 
 #include "effects.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 #include <QPainter>
 
+#include "hasher.hpp"
+
+namespace {
+
+// per-thread pool of reusable images, any image big enough is
+// given for requested size, so the caller must care about its content
+class SurfacePool final {
+public:
+  // RAII wrapper, returns image to the pool on destruction
+  class Surface final {
+  public:
+    explicit Surface(QSize sz) : _img(pool().acquire(sz)) {}
+    ~Surface() { pool().release(std::move(_img)); }
+
+    Surface(const Surface&) = delete;
+    Surface& operator=(const Surface&) = delete;
+
+    QImage* get() noexcept { return &_img; }
+    QImage* operator->() noexcept { return &_img; }
+    QImage& operator*() noexcept { return _img; }
+
+  private:
+    QImage _img;
+  };
+
+private:
+  static SurfacePool& pool()
+  {
+    static thread_local SurfacePool instance;
+    return instance;
+  }
+
+  QImage acquire(QSize sz)
+  {
+    // the smallest suitable image
+    auto iter = std::ranges::min_element(_images, {}, [sz](const QImage& img) {
+      return img.width() >= sz.width() && img.height() >= sz.height() ?
+                 qint64(img.width()) * img.height() : std::numeric_limits<qint64>::max();
+    });
+    if (iter != _images.end() && iter->width() >= sz.width() && iter->height() >= sz.height()) {
+      QImage img = std::move(*iter);
+      _images.erase(iter);
+      return img;
+    }
+    // round size up a bit to increase chances of reuse
+    auto rounded = QSize((sz.width() + 63) & ~63, (sz.height() + 63) & ~63);
+    return QImage(rounded, QImage::Format_ARGB32_Premultiplied);
+  }
+
+  void release(QImage img)
+  {
+    if (img.isNull())
+      return;
+    _images.push_back(std::move(img));
+    // keep only a few biggest images
+    if (_images.size() > max_images) {
+      auto iter = std::ranges::min_element(_images, {}, [](const QImage& i) {
+        return qint64(i.width()) * i.height();
+      });
+      _images.erase(iter);
+    }
+  }
+
+private:
+  static constexpr size_t max_images = 4;
+  std::vector<QImage> _images;
+};
+
+void paintBrush(QPainter* p, const QRectF& r, const QBrush& b, bool stretch)
+{
+  if (auto tx = b.texture(); !tx.isNull() && stretch) {
+    p->drawPixmap(r, tx, tx.rect());
+  } else {
+    p->setPen(Qt::NoPen);
+    p->setBrush(b);
+    p->drawRect(r);
+  }
+}
+
+// inner resources without cache key (-1) may change at any time
+size_t compositeKey(const ResourceDecorator& d)
+{
+  return d.ResourceDecorator::cacheKey() == size_t(-1) ? size_t(-1) : d.cacheKey();
+}
+
+// to distinguish effects with the same brush
+enum EffectKind : int { TexturingKind, BackgroundKind };
+
+} // namespace
+
+void BrushLayer::fill(QPainter* p, const QRectF& r, const QBrush& b, bool stretch)
+{
+  // solid color fill is cheap enough, and rotation is rare and hard to handle
+  const auto& t = p->transform();
+  if (b.style() == Qt::SolidPattern || b.style() == Qt::NoBrush || t.type() > QTransform::TxScale) {
+    paintBrush(p, r, b, stretch);
+    return;
+  }
+
+  const auto dpr = p->device()->devicePixelRatioF();
+  const auto sz = (t.mapRect(r).size() * dpr).toSize();
+  if (sz.isEmpty())
+    return;
+
+  if (_img.isNull() || _img.size() != sz || _rect != r || _dpr != dpr) {
+    _img = QImage(sz, QImage::Format_ARGB32_Premultiplied);
+    _img.fill(Qt::transparent);
+    QPainter pp(&_img);
+    pp.setRenderHints(p->renderHints());
+    pp.scale(sz.width() / r.width(), sz.height() / r.height());
+    pp.translate(-r.topLeft());
+    paintBrush(&pp, r, b, stretch);
+    _rect = r;
+    _dpr = dpr;
+  }
+
+  // 1:1 blit in device pixels
+  p->drawImage(r, _img, QRectF(_img.rect()));
+}
+
+CompositeLayer::State CompositeLayer::update(QPainter* p, const QRectF& r, size_t key)
+{
+  // rotation is rare and hard to handle
+  const auto& t = p->transform();
+  if (t.type() > QTransform::TxScale)
+    return Direct;
+
+  const auto dpr = p->device()->devicePixelRatioF();
+  const auto sz = (t.mapRect(r).size() * dpr).toSize();
+  if (sz.isEmpty())
+    return Direct;
+
+  if (key == size_t(-1))
+    return Direct;
+
+  auto iter = std::find_if(_entries.begin(), _entries.end(), [&](const Entry& e) {
+    return e.key == key && e.size == sz && e.rect == r && e.dpr == dpr;
+  });
+
+  if (iter == _entries.end()) {
+    // new content replaces the least recently drawn one
+    iter = _entries.end() - 1;
+    *iter = Entry{QImage(), key, sz, r, dpr};
+    std::rotate(_entries.begin(), iter, iter + 1);
+    return Direct;
+  }
+
+  std::rotate(_entries.begin(), iter, iter + 1);
+  auto& e = _entries.front();
+  if (!e.img.isNull())
+    return Ready;
+
+  // the same content is drawn again, worth caching
+  e.img = QImage(sz, QImage::Format_ARGB32_Premultiplied);
+  e.img.fill(Qt::transparent);
+  return Outdated;
+}
+
+void CompositeLayer::prepare(QPainter* pp, QPainter* p, const QRectF& r) const
+{
+  pp->setRenderHints(p->renderHints());
+  const auto& sz = _entries.front().size;
+  pp->scale(sz.width() / r.width(), sz.height() / r.height());
+  pp->translate(-r.topLeft());
+}
+
 void NewSurfaceDecorator::draw(QPainter* p)
 {
-  p->save();
-  QSize sz(p->device()->width(), p->device()->height());
-  sz *= p->device()->devicePixelRatioF();
-  QPixmap buffer(sz);
-  buffer.setDevicePixelRatio(p->device()->devicePixelRatioF());
-  buffer.fill(Qt::transparent);
+  // only area covered by the resource matters (plus a pixel for antialiasing)
+  const auto dev_rect = QRect(0, 0, p->device()->width(), p->device()->height());
+  const auto res_rect = p->transform().mapRect(rect()).toAlignedRect().adjusted(-1, -1, 1, 1);
+  const auto target = res_rect & dev_rect;
+  if (target.isEmpty())
+    return;
+
+  const auto dpr = p->device()->devicePixelRatioF();
+  const auto sz = (QSizeF(target.size()) * dpr).toSize().expandedTo(QSize(1, 1));
+
+  SurfacePool::Surface buffer(sz);
+  buffer->setDevicePixelRatio(dpr);
   {
-    QPainter pp(&buffer);
+    QPainter pp(buffer.get());
+    // pooled image may be bigger and has some garbage
+    pp.setCompositionMode(QPainter::CompositionMode_Source);
+    pp.fillRect(QRectF(QPointF(0, 0), QSizeF(sz) / dpr), Qt::transparent);
+    pp.setCompositionMode(QPainter::CompositionMode_SourceOver);
     pp.setRenderHints(p->renderHints());
-    pp.setTransform(p->transform());
+    pp.setTransform(p->transform() * QTransform::fromTranslate(-target.x(), -target.y()));
     ResourceDecorator::draw(&pp);
   }
+  p->save();
   p->resetTransform();
-  p->drawPixmap(0, 0, buffer);
+  p->drawImage(QRectF(target), *buffer, QRectF(QPointF(0, 0), sz));
   p->restore();
 }
 
@@ -32,19 +213,34 @@ Effect::ResourcePtr NewSurfaceEffect::decorate(ResourcePtr res)
   return std::make_shared<NewSurfaceDecorator>(std::move(res));
 }
 
+TexturingDecorator::TexturingDecorator(std::shared_ptr<Resource> r)
+  : ResourceDecorator(std::move(r))
+  , _brush_hash(hasher(_brush))
+{
+}
+
 void TexturingDecorator::draw(QPainter* p)
 {
-  ResourceDecorator::draw(p);
-  p->save();
-  p->setCompositionMode(QPainter::CompositionMode_SourceIn);
-  if (auto tx = _brush.texture(); !tx.isNull() && _stretch) {
-    p->drawPixmap(rect(), tx, tx.rect());
-  } else {
-    p->setPen(Qt::NoPen);
-    p->setBrush(_brush);
-    p->drawRect(rect());
-  }
-  p->restore();
+  _composite.draw(p, rect(), compositeKey(*this), [this](QPainter* pp) {
+    ResourceDecorator::draw(pp);
+    pp->save();
+    pp->setCompositionMode(QPainter::CompositionMode_SourceIn);
+    _layer.fill(pp, rect(), _brush, _stretch);
+    pp->restore();
+  });
+}
+
+size_t TexturingDecorator::cacheKey() const
+{
+  return qHashMulti(ResourceDecorator::cacheKey(), _brush_hash, _stretch, TexturingKind);
+}
+
+void TexturingDecorator::setBrush(QBrush b)
+{
+  _brush = std::move(b);
+  _brush_hash = hasher(_brush);
+  _layer.reset();
+  _composite.reset();
 }
 
 Effect::ResourcePtr TexturingEffect::decorate(ResourcePtr res)
@@ -55,19 +251,34 @@ Effect::ResourcePtr TexturingEffect::decorate(ResourcePtr res)
   return dres;
 }
 
+BackgroundDecorator::BackgroundDecorator(std::shared_ptr<Resource> r)
+  : ResourceDecorator(std::move(r))
+  , _brush_hash(hasher(_brush))
+{
+}
+
 void BackgroundDecorator::draw(QPainter* p)
 {
-  p->save();
-  p->setCompositionMode(QPainter::CompositionMode_SourceOver);
-  if (auto tx = _brush.texture(); !tx.isNull() && _stretch) {
-    p->drawPixmap(rect(), tx, tx.rect());
-  } else {
-    p->setPen(Qt::NoPen);
-    p->setBrush(_brush);
-    p->drawRect(rect());
-  }
-  p->restore();
-  ResourceDecorator::draw(p);
+  _composite.draw(p, rect(), compositeKey(*this), [this](QPainter* pp) {
+    pp->save();
+    pp->setCompositionMode(QPainter::CompositionMode_SourceOver);
+    _layer.fill(pp, rect(), _brush, _stretch);
+    pp->restore();
+    ResourceDecorator::draw(pp);
+  });
+}
+
+size_t BackgroundDecorator::cacheKey() const
+{
+  return qHashMulti(ResourceDecorator::cacheKey(), _brush_hash, _stretch, BackgroundKind);
+}
+
+void BackgroundDecorator::setBrush(QBrush b)
+{
+  _brush = std::move(b);
+  _brush_hash = hasher(_brush);
+  _layer.reset();
+  _composite.reset();
 }
 
 Effect::ResourcePtr BackgroundEffect::decorate(ResourcePtr res)
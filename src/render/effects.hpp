@@ -9,10 +9,82 @@
 #include "effect.hpp"
 #include "resource.hpp"
 
+#include <array>
+#include <optional>
+
 #include <QBrush>
+#include <QImage>
+#include <QPainter>
+
+// pre-rendered brush fill, turns gradients and textures into a blit,
+// re-rendered only when brush, target rect or device size are changed
+class BrushLayer final {
+public:
+  void fill(QPainter* p, const QRectF& r, const QBrush& b, bool stretch);
+  void reset() noexcept { _img = QImage(); }
+
+private:
+  QImage _img;
+  QRectF _rect;
+  qreal _dpr = 1.0;
+};
+
+// pre-rendered decorator output, turns the whole effect into a blit,
+// keyed by decorator's cache key (inner key + effect parameters) and
+// device size, the output is cached only when the same key is drawn
+// again, so constantly changing content is just drawn directly,
+// two the most recently drawn keys are kept, so alternating content
+// (e.g. blinking separator) is cached too,
+// key -1 means that the content can't be cached
+class CompositeLayer final {
+public:
+  template<typename Render>
+  void draw(QPainter* p, const QRectF& r, size_t key, Render&& render)
+  {
+    switch (update(p, r, key)) {
+      case Direct:
+        render(p);
+        break;
+      case Outdated: {
+        QPainter pp(&_entries.front().img);
+        prepare(&pp, p, r);
+        render(&pp);
+      }
+        [[fallthrough]];
+      case Ready: {
+        // 1:1 blit in device pixels
+        const auto& img = _entries.front().img;
+        p->drawImage(r, img, QRectF(img.rect()));
+        break;
+      }
+    }
+  }
+
+  void reset() noexcept { _entries = {}; }
+
+private:
+  enum State { Direct, Outdated, Ready };
+
+  // makes the entry for given parameters the first one
+  State update(QPainter* p, const QRectF& r, size_t key);
+  void prepare(QPainter* pp, QPainter* p, const QRectF& r) const;
+
+private:
+  struct Entry {
+    QImage img;   // null until the same content is drawn again
+    std::optional<size_t> key;
+    QSize size;
+    QRectF rect;
+    qreal dpr = 1.0;
+  };
+
+  // the most recently drawn entry is the first
+  std::array<Entry, 2> _entries;
+};
 
 // creates new drawing surface and draws inner item on it
-// new surface size is equal to the size of the orinal one
+// new surface covers only the area of the inner item,
+// surfaces are taken from per-thread pool, not allocated each time
 class NewSurfaceDecorator final : public ResourceDecorator {
 public:
   using ResourceDecorator::ResourceDecorator;
@@ -28,19 +100,25 @@ public:
 // applies texture to inner item, tiles by default
 class TexturingDecorator final : public ResourceDecorator {
 public:
-  using ResourceDecorator::ResourceDecorator;
+  explicit TexturingDecorator(std::shared_ptr<Resource> r);
 
   void draw(QPainter* p) override;
 
+  // brush and stretch flag affect the result
+  size_t cacheKey() const override;
+
   QBrush brush() const noexcept { return _brush; }
   bool stretch() const noexcept { return _stretch; }
 
-  void setBrush(QBrush b) noexcept { _brush = std::move(b); }
-  void setStretch(bool s) noexcept { _stretch = s; }
+  void setBrush(QBrush b);
+  void setStretch(bool s) noexcept { _stretch = s; _layer.reset(); _composite.reset(); }
 
 private:
   QBrush _brush = QColor(128, 64, 240);
   bool _stretch = false;
+  size_t _brush_hash = 0;
+  BrushLayer _layer;
+  CompositeLayer _composite;
 };
 
 class TexturingEffect final : public Effect {
@@ -61,19 +139,25 @@ private:
 // fills background and draws inner item on it
 class BackgroundDecorator final : public ResourceDecorator {
 public:
-  using ResourceDecorator::ResourceDecorator;
+  explicit BackgroundDecorator(std::shared_ptr<Resource> r);
 
   void draw(QPainter* p) override;
 
+  // brush and stretch flag affect the result
+  size_t cacheKey() const override;
+
   QBrush brush() const noexcept { return _brush; }
   bool stretch() const noexcept { return _stretch; }
 
-  void setBrush(QBrush b) noexcept { _brush = std::move(b); }
-  void setStretch(bool s) noexcept { _stretch = s; }
+  void setBrush(QBrush b);
+  void setStretch(bool s) noexcept { _stretch = s; _layer.reset(); _composite.reset(); }
 
 private:
   QBrush _brush = QColor(240, 224, 64);
   bool _stretch = false;
+  size_t _brush_hash = 0;
+  BrushLayer _layer;
+  CompositeLayer _composite;
 };
 
 class BackgroundEffect final : public Effect {
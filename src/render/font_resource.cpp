@@ -8,10 +8,35 @@
 
 #include <QFontMetricsF>
 #include <QPainter>
+#include <QTextLayout>
+
+namespace {
+
+// shaping and font fallback happen here, only once per character
+QList<QGlyphRun> resolveGlyphs(const QFont& font, char32_t ch)
+{
+  QTextLayout layout(QString::fromUcs4(&ch, 1), font);
+  layout.beginLayout();
+  auto line = layout.createLine();
+  layout.endLayout();
+  if (!line.isValid())
+    return {};
+
+  // glyphs are positioned relative to line top, but drawText() uses baseline
+  auto runs = layout.glyphRuns();
+  for (auto& run : runs) {
+    auto positions = run.positions();
+    for (auto& pos : positions)
+      pos.ry() -= line.ascent();
+    run.setPositions(positions);
+  }
+  return runs;
+}
+
+} // namespace
 
 FontResource::FontResource(const QFont& font, char32_t ch)
-    : _ch(ch)
-    , _font(font)
+    : _glyphs(resolveGlyphs(font, ch))
     , _hash(qHashMulti(0, font, ch))
 {
   QFontMetricsF fmf(font);
@@ -20,17 +45,15 @@ FontResource::FontResource(const QFont& font, char32_t ch)
     _ax = fmf.horizontalAdvance(QChar(ch));
   } else {
     _br = fmf.tightBoundingRect(QString::fromUcs4(&ch, 1));
-    _ax = (_font.italic() ? 0.8 : 1.0) * _br.width();
+    _ax = (font.italic() ? 0.8 : 1.0) * _br.width();
   }
   _ay = fmf.lineSpacing();
 }
 
 void FontResource::draw(QPainter* p)
 {
-  p->save();
-  p->setFont(_font);
-  p->drawText(0, 0, QString::fromUcs4(&_ch, 1));
-  p->restore();
+  for (const auto& run : std::as_const(_glyphs))
+    p->drawGlyphRun(QPointF(0, 0), run);
 }
 
 qreal FontResourceFactory::ascent() const
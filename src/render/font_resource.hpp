@@ -9,7 +9,10 @@
 #include "resource_factory.hpp"
 
 #include <QFont>
+#include <QGlyphRun>
 
+// character is resolved to glyph(s) of the font (or the fallback font
+// if the font has no such glyph) only once, only glyphs are drawn then
 class FontResource final : public Resource {
 public:
   FontResource(const QFont& font, char32_t ch);
@@ -23,11 +26,10 @@ public:
   size_t cacheKey() const noexcept override { return _hash; }
 
 private:
-  char32_t _ch;
+  QList<QGlyphRun> _glyphs;   // positioned relative to baseline origin
   QRectF _br;
   qreal _ax;
   qreal _ay;
-  const QFont& _font;
   size_t _hash;
 };
 
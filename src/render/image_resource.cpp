@@ -6,14 +6,145 @@
 
 #include "image_resource.hpp"
 
+#include <algorithm>
+#include <cmath>
+
+#include <QDir>
+#include <QFileInfo>
 #include <QPainter>
+#include <QtMath>
+
+namespace {
+
+constexpr std::size_t max_cached_scales = 4;
+// larger images are not worth caching
+constexpr int max_cached_size = 4096;
+
+// image size in device pixels for given scale factors
+QSize deviceSize(const QSizeF& sz, qreal sx, qreal sy)
+{
+  return {qCeil(sz.width() * sx), qCeil(sz.height() * sy)};
+}
+
+// "name@Nx.ext" file next to "name.ext", the same QIcon looks for
+QString highResolutionFile(const QString& filename, int n)
+{
+  const QFileInfo fi(filename);
+  const auto name = QStringLiteral("%1@%2x").arg(fi.completeBaseName()).arg(n);
+  const auto file = fi.dir().filePath(fi.suffix().isEmpty() ? name : name + u'.' + fi.suffix());
+  return QFileInfo::exists(file) ? file : QString();
+}
+
+bool worthCaching(const QSize& sz)
+{
+  return !sz.isEmpty() && sz.width() <= max_cached_size && sz.height() <= max_cached_size;
+}
+
+} // namespace
+
+const QImage& ScaledImageCache::get(QSize sz, const std::function<QImage(QSize)>& make)
+{
+  auto iter = std::ranges::find(m_images, sz, &QImage::size);
+  if (iter != m_images.end()) {
+    std::rotate(m_images.begin(), iter, iter + 1);
+    return m_images.front();
+  }
+
+  if (m_images.size() >= max_cached_scales)
+    m_images.pop_back();
+  m_images.insert(m_images.begin(), make(sz));
+  return m_images.front();
+}
+
+
+RasterImageResource::RasterImageResource(const QString& filename)
+  : ImageResource(filename)
+{
+  QImage img(filename);
+  if (img.isNull())
+    return;
+  initGeometry(img.size());
+
+  // the same high resolution files QIcon would use, the largest one wins
+  QImage source = std::move(img);
+  for (int n : {2, 3, 4}) {
+    if (auto file = highResolutionFile(filename, n); !file.isEmpty())
+      if (QImage hr(file); !hr.isNull())
+        source = std::move(hr);
+  }
+
+  m_levels.push_back(source.convertToFormat(QImage::Format_ARGB32_Premultiplied));
+  while (m_levels.back().width() > 1 && m_levels.back().height() > 1) {
+    const auto& prev = m_levels.back();
+    m_levels.push_back(prev.scaled(prev.size() / 2, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+  }
+}
 
 void RasterImageResource::draw(QPainter* p)
 {
-  p->drawPixmap(rect().toRect(), m_icon.pixmap(m_size));
+  if (m_levels.empty())
+    return;
+
+  const auto t = p->deviceTransform();
+  const auto sz = deviceSize(rect().size(), std::abs(t.m11()), std::abs(t.m22()));
+
+  QMutexLocker lock(&m_mutex);
+  if (t.type() > QTransform::TxScale || !worthCaching(sz)) {
+    p->drawImage(rect(), level(sz));
+    return;
+  }
+
+  p->drawImage(rect(), m_images.get(sz, [this](QSize sz) { return scaled(sz); }));
+}
+
+// the smallest level that is not smaller than requested size
+const QImage& RasterImageResource::level(QSize sz) const
+{
+  auto iter = std::find_if(m_levels.rbegin(), m_levels.rend(), [sz](const QImage& l) {
+    return l.width() >= sz.width() && l.height() >= sz.height();
+  });
+  return iter != m_levels.rend() ? *iter : m_levels.front();
+}
+
+// exactly requested size, made from the nearest mipmap level
+QImage RasterImageResource::scaled(QSize sz) const
+{
+  const auto& img = level(sz);
+  if (img.size() == sz)
+    return img;
+  return img.scaled(sz, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
 }
 
+
 void SvgImageResource::draw(QPainter* p)
 {
-  m_renderer->render(p, rect());
+  const auto t = p->deviceTransform();
+  const auto sz = deviceSize(rect().size(), std::abs(t.m11()), std::abs(t.m22()));
+
+  QMutexLocker lock(&m_mutex);
+  if (t.type() > QTransform::TxScale || !worthCaching(sz)) {
+    m_renderer->render(p, rect());
+    return;
+  }
+
+  p->drawImage(rect(), m_images.get(sz, [this](QSize sz) { return rendered(sz); }));
+}
+
+void SvgImageResource::warmUp(const QList<qreal>& scales)
+{
+  QMutexLocker lock(&m_mutex);
+  for (auto k : scales)
+    if (auto sz = deviceSize(rect().size(), k, k); worthCaching(sz))
+      m_images.get(sz, [this](QSize sz) { return rendered(sz); });
+}
+
+QImage SvgImageResource::rendered(QSize sz) const
+{
+  QImage img(sz, QImage::Format_ARGB32_Premultiplied);
+  img.fill(Qt::transparent);
+  QPainter p(&img);
+  p.setRenderHint(QPainter::Antialiasing);
+  p.setRenderHint(QPainter::SmoothPixmapTransform);
+  m_renderer->render(&p, QRectF(QPointF(0, 0), sz));
+  return img;
 }
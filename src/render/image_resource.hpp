@@ -8,9 +8,12 @@
 
 #include "resource.hpp"
 
+#include <functional>
 #include <memory>
+#include <vector>
 
-#include <QIcon>
+#include <QImage>
+#include <QMutex>
 #include <QSvgRenderer>
 
 class ImageResource : public Resource {
@@ -48,24 +51,42 @@ private:
 };
 
 
+// a few recently used images of different sizes (device scales)
+class ScaledImageCache {
+public:
+  // returns image of given size, it is created by given function if not cached
+  const QImage& get(QSize sz, const std::function<QImage(QSize)>& make);
+
+private:
+  std::vector<QImage> m_images;   // most recently used first
+};
+
+
+// images are prepared for each device scale they are drawn with,
+// "@Nx" variants of the file are used as high resolution sources,
+// scaled images are produced from the nearest level of mipmap chain
+// (each level is half size of the previous), not from the source
 class RasterImageResource : public ImageResource {
 public:
-  explicit RasterImageResource(const QString& filename)
-    : ImageResource(filename)
-    , m_icon(filename)
-    , m_size(m_icon.availableSizes().constFirst())
-  {
-    initGeometry(m_size);
-  }
+  explicit RasterImageResource(const QString& filename);
 
   void draw(QPainter* p) override;
 
 private:
-  QIcon m_icon;   // QIcon perfectly handles HighDPI
-  QSize m_size;   // 100% image size
+  const QImage& level(QSize sz) const;
+  QImage scaled(QSize sz) const;
+
+private:
+  // level 0 is the highest resolution image available
+  std::vector<QImage> m_levels;
+  ScaledImageCache m_images;
+  QMutex m_mutex;
 };
 
 
+// SVG is rendered into an image once per device scale, and only this
+// image is drawn until scale changes, only a few recent scales are kept
+// rotated/sheared painters get direct (not cached) rendering
 class SvgImageResource : public ImageResource {
 public:
   explicit SvgImageResource(const QString& filename)
@@ -77,6 +98,15 @@ public:
 
   void draw(QPainter* p) override;
 
+  // pre-renders images for given device scales (e.g. screens DPR),
+  // may be called from any thread
+  void warmUp(const QList<qreal>& scales);
+
+private:
+  QImage rendered(QSize sz) const;
+
 private:
   std::unique_ptr<QSvgRenderer> m_renderer;
+  ScaledImageCache m_images;
+  QMutex m_mutex;
 };
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <QHash>
+#include <QMutex>
 
 #include "resource.hpp"
 
@@ -14,8 +15,10 @@ class ResourceFactory {
 public:
   virtual ~ResourceFactory() = default;
 
+  // may be called from any thread
   std::shared_ptr<Resource> item(char32_t ch) const
   {
+    QMutexLocker lock(&_mutex);
     auto& resource = _cache[ch];
     if (!resource) resource = create(ch);
     return resource;
@@ -31,4 +34,5 @@ protected:
 
 private:
   mutable QHash<char32_t, std::shared_ptr<Resource>> _cache;
+  mutable QMutex _mutex;
 };
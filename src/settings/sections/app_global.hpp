@@ -21,6 +21,7 @@ class AppGlobalConfig final : public ConfigBaseQVariant {
   CONFIG_OPTION_Q(bool, ChangeOpacityOnMouseHover, false)
   CONFIG_OPTION_Q(qreal, OpacityOnMouseHover, 0.1)
   CONFIG_OPTION_Q(bool, EnableDebugOptions, false)
+  CONFIG_OPTION_Q(bool, RenderAhead, false)
 public:
   using ConfigBaseQVariant::ConfigBaseQVariant;
 };
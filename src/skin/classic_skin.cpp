@@ -6,62 +6,36 @@
 
 #include "classic_skin.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+
 #include "datetime_formatter.hpp"
-#include "effects.hpp"
+#include "effects_stack.hpp"
+#include "flat_layout.hpp"
+#include "frame_arena.hpp"
 #include "hasher.hpp"
-#include "linear_layout.hpp"
+#include "layout_debug.hpp"
 
 namespace {
 
-template<class Effect>
-std::shared_ptr<Resource> createEffect(std::shared_ptr<Resource> inner, QBrush b, bool stretch)
-{
-  auto effect = std::make_shared<Effect>(std::move(inner));
-  effect->setBrush(std::move(b));
-  effect->setStretch(stretch);
-  return effect;
-}
-
-std::shared_ptr<Resource> buildEffectsStack(std::shared_ptr<Resource> g, auto tx_cfg, auto bg_cfg)
-{
-  auto [bg, bg_stretch] = bg_cfg;
-  auto [tx, tx_stretch] = tx_cfg;
-
-  if (bg.style() == Qt::NoBrush && tx.style() == Qt::NoBrush) {
-    // do nothing
-  }
-  if (bg.style() != Qt::NoBrush && tx.style() == Qt::NoBrush) {
-    g = createEffect<BackgroundDecorator>(std::move(g), std::move(bg), bg_stretch);
-  }
-  if (bg.style() == Qt::NoBrush && tx.style() != Qt::NoBrush) {
-    g = createEffect<TexturingDecorator>(std::move(g), std::move(tx), tx_stretch);
-    g = std::make_shared<NewSurfaceDecorator>(std::move(g));
-  }
-  if (bg.style() != Qt::NoBrush && tx.style() != Qt::NoBrush) {
-    g = createEffect<TexturingDecorator>(std::move(g), std::move(tx), tx_stretch);
-    g = std::make_shared<NewSurfaceDecorator>(std::move(g));
-    g = createEffect<BackgroundDecorator>(std::move(g), std::move(bg), bg_stretch);
-  }
-
-  return g;
-}
-
-void applyLayoutConfig(LinearLayout& l, QStringView cfg) noexcept
+void applyLayoutConfig(FlatLayout& l, std::span<const FlatLayout::NodeId> items,
+                       QStringView cfg) noexcept
 {
-  for (qsizetype i = 0; i < std::min<qsizetype>(l.items().size(), cfg.length()); i++) {
+  for (qsizetype i = 0; i < std::min<qsizetype>(items.size(), cfg.length()); i++) {
     switch (cfg[i].unicode()) {
       case '1':
-        l.items()[i]->enableResize();
+        l.setResizeEnabled(items[i], true);
         break;
       case '<':
-        l.setItemAlignment(i, Qt::AlignLeft | Qt::AlignTop);
+        l.setAlignment(items[i], Qt::AlignLeft | Qt::AlignTop);
         break;
       case '>':
-        l.setItemAlignment(i, Qt::AlignRight | Qt::AlignBottom);
+        l.setAlignment(items[i], Qt::AlignRight | Qt::AlignBottom);
         break;
       case 'x':
       case 'X':
-        l.setItemAlignment(i, Qt::AlignCenter);
+        l.setAlignment(items[i], Qt::AlignCenter);
         break;
       case '0':
       default:
@@ -90,129 +64,149 @@ private:
 };
 
 
-class ResRectOverride final : public ResourceDecorator {
-public:
-  using ResourceDecorator::ResourceDecorator;
+// single glyph description, formatted string is converted to glyphs list
+struct Glyph {
+  char32_t ch = 0;
+  bool visible = true;
+  QTransform transform;   // token-specific transform
 
-  QRectF rect() const override
-  {
-    return _rect.isValid() ? _rect : ResourceDecorator::rect();
-  }
+  bool isLineBreak() const noexcept { return ch == '\n'; }
+};
 
-  void setRect(QRectF r) noexcept { _rect = std::move(r); }
+using GlyphsList = std::vector<Glyph>;
 
-private:
-  QRectF _rect;
-};
+// glyphs can be replaced in already built layout
+// only if lines and transforms are the same
+bool hasSameStructure(const GlyphsList& lhs, const GlyphsList& rhs)
+{
+  return std::ranges::equal(lhs, rhs, [](const auto& l, const auto& r) {
+    return l.isLineBreak() == r.isLineBreak() && l.transform == r.transform;
+  });
+}
 
 
-class ClassicLayoutBuilder : public DateTimeStringBuilder {
+// builds resources stack (with all effects) for each glyph only once,
+// the same stack is shared between all glyph occurrences,
+// stacks are allocated in the given arena (if any)
+class GlyphStacks final {
 public:
-  ClassicLayoutBuilder(std::shared_ptr<ResourceFactory> factory,
-                       const ClassicSkinBase& skin)
-    : _line(std::make_shared<LinearLayout>(skin.orientation(), skin.spacing()))
-    , _factory(std::move(factory))
+  GlyphStacks(std::shared_ptr<ResourceFactory> factory,
+              const ClassicSkinBase& skin, size_t skin_cfg_hash,
+              std::shared_ptr<FrameArena> arena = nullptr)
+    : _factory(std::move(factory))
     , _skin(skin)
+    , _skin_cfg_hash(skin_cfg_hash)
+    , _arena(std::move(arena))
+  {}
+
+  // may return nullptr if there is no resource for given character
+  std::shared_ptr<Resource> get(char32_t c, bool visible)
   {
-    applyIgnoreAdvanceOptions(*_line);
+    auto& stacks = visible ? _visible : _invisible;
+    auto iter = stacks.find(c);
+    if (iter == stacks.end())
+      iter = stacks.insert(c, build(c, visible));
+    return iter.value();
   }
 
-  void addCharacter(char32_t c) override
+private:
+  std::shared_ptr<Resource> build(char32_t c, bool visible) const
   {
-    if (c == '\n') {
-      if (!_layout) {
-        auto o = _skin.orientation() == Qt::Horizontal ? Qt::Vertical : Qt::Horizontal;
-        _layout = std::make_shared<LinearLayout>(o, _skin.spacing());
-        applyIgnoreAdvanceOptions(*_layout);
-      }
-      addLine(std::move(_line));
-      _line = std::make_shared<LinearLayout>(_skin.orientation(), _skin.spacing());
-      applyIgnoreAdvanceOptions(*_line);
-      return;
-    }
-    addItem(c);
+    auto r = _factory->item(c);
+    if (!r)
+      return nullptr;
+    if (!visible)
+      return makeShared<InvisibleResource>(_arena, r->rect(), r->advanceX(), r->advanceY());
+    return buildItemStack(std::move(r));
   }
 
-  void setSkinConfigHash(size_t hash) noexcept { _skin_cfg_hash = hash; }
+  std::shared_ptr<Resource> buildItemStack(std::shared_ptr<Resource> item) const
+  {
+    std::pair<QBrush, bool> tx;
+    std::pair<QBrush, bool> bg;
+    if (_skin.texturePerElement()) tx.first = _skin.texture();
+    if (_skin.backgroundPerElement()) bg.first = _skin.background();
+    tx.second = _skin.textureStretch();
+    bg.second = _skin.backgroundStretch();
+    item = buildEffectsStack(_arena, std::move(item), std::move(tx), std::move(bg));
+    item = makeShared<CacheKeyUpdater>(_arena, std::move(item), _skin_cfg_hash);
+    if (_skin.cachingEnabled()) item = makeShared<CachedResource>(_arena, item, _skin.glyphCache());
+    return item;
+  }
 
-  void setGlyphScaleFactor(qreal ks) noexcept { _ks = ks; }
+private:
+  std::shared_ptr<ResourceFactory> _factory;
+  const ClassicSkinBase& _skin;
+  size_t _skin_cfg_hash;
+  std::shared_ptr<FrameArena> _arena;
+
+  QHash<char32_t, std::shared_ptr<Resource>> _visible;
+  QHash<char32_t, std::shared_ptr<Resource>> _invisible;
+};
 
-  std::shared_ptr<Resource> getLayout()
+
+// builds flat layout: lines of glyphs placed one after another,
+// multiple lines are placed in the opposite direction
+// layout and its effects are allocated in the given arena (if any),
+// builder's own temporary data is kept on the stack when possible
+class ClassicLayoutBuilder final {
+public:
+  ClassicLayoutBuilder(GlyphStacks& stacks, const ClassicSkinBase& skin,
+                       const ResourceFactory& factory,
+                       std::shared_ptr<FrameArena> arena = nullptr)
+    : _stacks(stacks)
+    , _skin(skin)
+    , _factory(factory)
+    , _arena(std::move(arena))
   {
-    std::shared_ptr<LayoutItem> layout;
-    if (_layout) {
-      addLine(std::move(_line));
-      applyLayoutConfig(*_layout, _skin.layoutConfig());
-      _layout->updateGeometry();
-      layout = std::move(_layout);
-    } else {
-      std::swap(_layout, _line);
-      layout = updateLineRect(std::move(_layout));
-    }
-    return buildLayoutStack(layout->resource());
+    _lines.emplace_back();
   }
 
-protected:
-  void addItem(char32_t c, bool visible = true)
+  ClassicLayoutBuilder(const ClassicLayoutBuilder&) = delete;
+  ClassicLayoutBuilder& operator=(const ClassicLayoutBuilder&) = delete;
+
+  void addGlyph(const Glyph& g)
   {
-    auto r = _factory->item(c);
-    if (!r)
+    const auto idx = _glyphs_count++;
+    if (g.isLineBreak()) {
+      _lines.emplace_back();
       return;
-    if (visible)
-      r = buildItemStack(std::move(r));
-    else
-      r = std::make_shared<InvisibleResource>(r->rect(), r->advanceX(), r->advanceY());
-    auto item = std::make_shared<LayoutItem>(std::move(r));
-    item->setTransform(itemTransform(c).scale(_ks, _ks));
-    _line->addItem(std::move(item));
+    }
+    if (auto r = _stacks.get(g.ch, g.visible))
+      _lines.back().push_back({std::move(r), QTransform(g.transform).scale(_ks, _ks), idx});
   }
 
-  virtual QTransform itemTransform(char32_t c) const noexcept { return QTransform(); }
+  void setGlyphScaleFactor(qreal ks) noexcept { _ks = ks; }
 
-private:
-  void addLine(std::shared_ptr<LinearLayout> line)
+  // returns the whole layout, its geometry is up to date
+  std::shared_ptr<FlatLayout> getLayout()
   {
-    _layout->addItem(updateLineRect(std::move(line)));
-    Q_ASSERT(_layout->rect().isNull());
-  }
+    auto layout = makeShared<FlatLayout>(_arena, memoryResource(_arena));
+    // root, lines and glyphs (line breaks are counted as glyphs too)
+    layout->reserve(static_cast<FlatLayout::NodeId>(1 + _glyphs_count + _lines.size()));
+    _nodes.assign(_glyphs_count, FlatLayout::no_node);
 
-  // returns updated layout item that should be used instead
-  // given layout item is not modified
-  std::shared_ptr<LayoutItem> updateLineRect(std::shared_ptr<LayoutItem> line)
-  {
-    Q_ASSERT(line->rect().isNull());
-    line->updateGeometry();
-    if (_skin.ignoreAdvanceY()) return line;
-    auto r = line->resource()->rect();
-    // do not strictly rely on ascent/descent values
-    // in case of Unicode characters not supported by selected font
-    // some fallback font can be used, and it has different metrics
-    r.setTop(std::min(r.top(), -_factory->ascent()));
-    r.setBottom(std::max(r.bottom(), _factory->descent()));
-    // why is it here? to preserve line height!
-    auto res = std::make_shared<ResRectOverride>(line->resource());
-    res->setRect(std::move(r));
-    return std::make_shared<LayoutItem>(std::move(res));
-  }
+    if (_lines.size() == 1) {
+      addLine(*layout, FlatLayout::no_node, _lines.front());
+    } else {
+      auto o = _skin.orientation() == Qt::Horizontal ? Qt::Vertical : Qt::Horizontal;
+      const auto root = addLayout(*layout, FlatLayout::no_node, o);
+      std::pmr::vector<FlatLayout::NodeId> lines(&_tmp);
+      lines.reserve(_lines.size());
+      for (const auto& line : _lines)
+        lines.push_back(addLine(*layout, root, line));
+      applyLayoutConfig(*layout, lines, _skin.layoutConfig());
+    }
 
-  void applyIgnoreAdvanceOptions(LinearLayout& l) const noexcept
-  {
-    if (l.orientation() == Qt::Horizontal) l.setIgnoreAdvance(_skin.ignoreAdvanceX());
-    if (l.orientation() == Qt::Vertical) l.setIgnoreAdvance(_skin.ignoreAdvanceY());
+    layout->updateGeometry();
+    return layout;
   }
 
-  std::shared_ptr<Resource> buildItemStack(std::shared_ptr<Resource> item) const
+  // one node per added glyph, no_node for line breaks and missing glyphs,
+  // given list is re-used to avoid allocations
+  void getGlyphNodes(std::vector<FlatLayout::NodeId>& nodes) const
   {
-    std::pair<QBrush, bool> tx;
-    std::pair<QBrush, bool> bg;
-    if (_skin.texturePerElement()) tx.first = _skin.texture();
-    if (_skin.backgroundPerElement()) bg.first = _skin.background();
-    tx.second = _skin.textureStretch();
-    bg.second = _skin.backgroundStretch();
-    item = buildEffectsStack(std::move(item), std::move(tx), std::move(bg));
-    item = std::make_shared<CacheKeyUpdater>(std::move(item), _skin_cfg_hash);
-    if (_skin.cachingEnabled()) item = std::make_shared<CachedResource>(item);
-    return item;
+    nodes.assign(_nodes.begin(), _nodes.end());
   }
 
   std::shared_ptr<Resource> buildLayoutStack(std::shared_ptr<Resource> item) const
@@ -223,29 +217,83 @@ private:
     if (!_skin.backgroundPerElement()) bg.first = _skin.background();
     tx.second = _skin.textureStretch();
     bg.second = _skin.backgroundStretch();
-    return buildEffectsStack(std::move(item), std::move(tx), std::move(bg));
+    // whole lines are not put into glyph cache: with seconds shown they
+    // never repeat, and they would evict glyphs, repeated frames (e.g.
+    // with and without separator) are handled by the effects themselves
+    return buildEffectsStack(_arena, std::move(item), std::move(tx), std::move(bg));
   }
 
 private:
-  std::shared_ptr<LinearLayout> _line;
-  std::shared_ptr<LinearLayout> _layout;
-  std::shared_ptr<ResourceFactory> _factory;
+  struct GlyphEntry {
+    std::shared_ptr<Resource> res;
+    QTransform transform;
+    size_t idx;   // index of added glyph
+  };
+
+  using Line = std::pmr::vector<GlyphEntry>;
+
+  // enough for a few lines of date/time
+  static constexpr std::size_t tmp_buffer_size = 4096;
+
+  FlatLayout::NodeId addLayout(FlatLayout& l, FlatLayout::NodeId parent, Qt::Orientation o) const
+  {
+    const bool ignore_advance = o == Qt::Horizontal ? _skin.ignoreAdvanceX() : _skin.ignoreAdvanceY();
+    return l.addLayout(parent, o, _skin.spacing(), ignore_advance);
+  }
+
+  FlatLayout::NodeId addLine(FlatLayout& l, FlatLayout::NodeId parent, const Line& line)
+  {
+    const auto id = addLayout(l, parent, _skin.orientation());
+    // why is it here? to preserve line height!
+    // in case of Unicode characters not supported by selected font
+    // some fallback font can be used, and it has different metrics
+    if (!_skin.ignoreAdvanceY())
+      l.setLineMetrics(id, _factory.ascent(), _factory.descent());
+    for (const auto& g : line)
+      _nodes[g.idx] = l.addItem(id, g.res, g.transform);
+    return id;
+  }
+
+private:
+  GlyphStacks& _stacks;
   const ClassicSkinBase& _skin;
+  const ResourceFactory& _factory;
+  std::shared_ptr<FrameArena> _arena;
 
-  size_t _skin_cfg_hash = 0;
+  alignas(std::max_align_t) std::array<std::byte, tmp_buffer_size> _tmp_buffer;
+  std::pmr::monotonic_buffer_resource _tmp{_tmp_buffer.data(), _tmp_buffer.size()};
+  std::pmr::vector<Line> _lines{&_tmp};
+  std::pmr::vector<FlatLayout::NodeId> _nodes{&_tmp};
+  size_t _glyphs_count = 0;
 
   qreal _ks = 1.0;
 };
 
 
-class DateTimeLayoutBuilder : public ClassicLayoutBuilder {
+// glyphs range [first, last) produced by some token
+using TokenRange = std::pair<size_t, size_t>;
+using TokenRangesList = std::vector<TokenRange>;
+
+class DateTimeGlyphsBuilder final : public DateTimeStringBuilder {
 public:
-  DateTimeLayoutBuilder(std::shared_ptr<ResourceFactory> factory,
-                        const ClassicSkin& skin)
-    : ClassicLayoutBuilder(std::move(factory), skin)
-    , _skin(skin)
+  DateTimeGlyphsBuilder(const ClassicSkin& skin, GlyphsList& glyphs, TokenRangesList& tokens)
+    : _skin(skin)
+    , _glyphs(glyphs)
+    , _tokens(tokens)
   {}
 
+  // glyphs of unchanged tokens are taken from the previous result
+  void setPreviousResult(const GlyphsList& glyphs, const TokenRangesList& tokens) noexcept
+  {
+    _prev_glyphs = &glyphs;
+    _prev_tokens = &tokens;
+  }
+
+  void addCharacter(char32_t c) override
+  {
+    addGlyph(c, true);
+  }
+
   void addSeparator(char32_t c) override
   {
     if (_supports_custom_separator && _separator_idx < _separators.size())
@@ -264,18 +312,30 @@ public:
       }
     }
 
-    addItem(c, separator_visible);
+    addGlyph(c, separator_visible);
   }
 
   void tokenStart(QStringView token) override
   {
-    _current_token = token.toString();
+    _current_transform = _skin.tokenTransform(token);
+    _token_start = _glyphs.size();
   }
 
   void tokenEnd(QStringView token) override
   {
     Q_UNUSED(token)
-    _current_token.clear();
+    _current_transform.reset();
+    _tokens.emplace_back(_token_start, _glyphs.size());
+  }
+
+  void tokenUnchanged(QStringView token) override
+  {
+    Q_UNUSED(token)
+    Q_ASSERT(_prev_glyphs && _prev_tokens && _tokens.size() < _prev_tokens->size());
+    const auto [first, last] = (*_prev_tokens)[_tokens.size()];
+    const auto start = _glyphs.size();
+    _glyphs.insert(_glyphs.end(), _prev_glyphs->begin() + first, _prev_glyphs->begin() + last);
+    _tokens.emplace_back(start, _glyphs.size());
   }
 
   void setSupportsCustomSeparator(bool supports) noexcept
@@ -303,15 +363,20 @@ public:
     _separator_visible = visible;
   }
 
-protected:
-  QTransform itemTransform(char32_t c) const noexcept override
+private:
+  void addGlyph(char32_t c, bool visible)
   {
-    Q_UNUSED(c);
-    return _skin.tokenTransform(_current_token);
+    _glyphs.push_back({c, visible, _current_transform});
   }
 
 private:
   const ClassicSkin& _skin;
+  GlyphsList& _glyphs;
+  TokenRangesList& _tokens;
+
+  const GlyphsList* _prev_glyphs = nullptr;
+  const TokenRangesList* _prev_tokens = nullptr;
+  size_t _token_start = 0;
 
   bool _supports_custom_separator = false;
   bool _supports_separator_animation = false;
@@ -321,23 +386,189 @@ private:
   quint32 _separator_idx = 0;
   QList<uint> _separators;
 
-  QString _current_token;
+  QTransform _current_transform;
 };
 
 } // namespace
 
+// previously built layout, it is re-used between process() calls
+// as long as configuration and glyphs structure remain the same
+class ClassicSkin::Frame {
+public:
+  explicit Frame(const ClassicSkin& skin) noexcept
+    : _skin(skin)
+  {}
+
+  // prepares builder for the next frame, lists are re-used to avoid allocations
+  void setupBuilder(DateTimeGlyphsBuilder& builder) const noexcept
+  {
+    builder.setPreviousResult(_glyphs, _tokens);
+  }
+
+  GlyphsList& nextGlyphs() noexcept
+  {
+    _next_glyphs.clear();
+    return _next_glyphs;
+  }
+
+  TokenRangesList& nextTokens() noexcept
+  {
+    _next_tokens.clear();
+    return _next_tokens;
+  }
+
+  // date/time used for the previous frame, invalid if there is no such frame
+  const QDateTime& lastDateTime() const noexcept { return _last_dt; }
+
+  std::shared_ptr<Resource> update(const QDateTime& dt)
+  {
+    if (!_layout || !updateInPlace())
+      rebuild();
+    std::swap(_glyphs, _next_glyphs);
+    std::swap(_tokens, _next_tokens);
+    _last_dt = dt;
+    return _resource;
+  }
+
+  const std::optional<QRectF>& changedRect() const noexcept { return _changed_rect; }
+
+  const std::shared_ptr<FlatLayout>& layout() const noexcept { return _layout; }
+
+  // drops everything, the next update() will rebuild layout
+  void reset()
+  {
+    _resource.reset();
+    _layout.reset();
+    _nodes.clear();
+    _glyphs.clear();
+    _tokens.clear();
+    _stacks.reset();
+    _last_dt = QDateTime();
+    _changed_rect.reset();
+  }
+
+private:
+  // replaces only changed glyphs, returns false if it is not possible
+  bool updateInPlace()
+  {
+    if (!hasSameStructure(_glyphs, _next_glyphs))
+      return false;
+
+    Q_ASSERT(_nodes.size() == _next_glyphs.size());
+    QRectF changed_rect;
+    for (size_t i = 0; i < _next_glyphs.size(); i++) {
+      const auto& next = _next_glyphs[i];
+      const auto& curr = _glyphs[i];
+      if (next.ch == curr.ch && next.visible == curr.visible)
+        continue;
+
+      const auto node = _nodes[i];
+      auto r = _stacks->get(next.ch, next.visible);
+      if (node == FlatLayout::no_node || !r)
+        return false;   // missing glyph, layout must be rebuilt
+
+      if (!_layout->setResource(node, std::move(r)))
+        changed_rect |= _layout->geometryInRoot(node);
+    }
+
+    // relayout only if any glyph geometry has been changed,
+    // everything may move in this case
+    if (_layout->isGeometryDirty()) {
+      _layout->updateGeometry();
+      _changed_rect.reset();
+    } else {
+      _changed_rect = changed_rect;
+    }
+
+    return true;
+  }
+
+  void rebuild()
+  {
+    // glyph stacks live until configuration change, so they have own arena
+    if (!_stacks)
+      _stacks = std::make_unique<GlyphStacks>(_skin._factory, _skin, _skin._skin_cfg_hash,
+                                              std::make_shared<FrameArena>());
+
+    // frames are built in two arenas in turn: the previous frame is
+    // usually still held by window (it is shown until the new one is ready),
+    // but the frame before it is gone, so its memory can be re-used if
+    // nobody holds anything from it anymore, arena is kept alive by all
+    // objects allocated in it
+    _resource.reset();
+    _layout.reset();
+    _arena_idx ^= 1;
+    auto& arena = _arenas[_arena_idx];
+    if (arena && arena.use_count() == 1) {
+      // pairs with release done by shared_ptr's reference counter
+      std::atomic_thread_fence(std::memory_order_acquire);
+      arena->reset();
+    } else
+      arena = std::make_shared<FrameArena>();
+
+    ClassicLayoutBuilder builder(*_stacks, _skin, *_skin._factory, arena);
+    builder.setGlyphScaleFactor(_skin._k_base_size);
+    for (const auto& g : std::as_const(_next_glyphs)) builder.addGlyph(g);
+    _layout = builder.getLayout();
+    builder.getGlyphNodes(_nodes);
+    _resource = builder.buildLayoutStack(_layout);
+    _changed_rect.reset();
+  }
+
+private:
+  const ClassicSkin& _skin;
+
+  GlyphsList _glyphs;
+  GlyphsList _next_glyphs;
+  TokenRangesList _tokens;
+  TokenRangesList _next_tokens;
+  QDateTime _last_dt;
+  std::optional<QRectF> _changed_rect;
+
+  std::unique_ptr<GlyphStacks> _stacks;
+  std::array<std::shared_ptr<FrameArena>, 2> _arenas;
+  std::size_t _arena_idx = 0;
+  std::vector<FlatLayout::NodeId> _nodes;
+  std::shared_ptr<FlatLayout> _layout;
+  std::shared_ptr<Resource> _resource;
+};
+
+ClassicSkin::ClassicSkin(std::shared_ptr<ResourceFactory> factory)
+  : ClassicSkinBase(std::move(factory))
+  , _format(QLatin1String("hh:mm a"))
+  , _compiled_format(_format)
+  , _frame(std::make_unique<Frame>(*this))
+{
+}
+
+ClassicSkin::~ClassicSkin() = default;
+
 std::shared_ptr<Resource> ClassicSkin::process(const QDateTime& dt)
 {
-  DateTimeLayoutBuilder builder(_factory, *this);
+  DateTimeGlyphsBuilder builder(*this, _frame->nextGlyphs(), _frame->nextTokens());
+  _frame->setupBuilder(builder);
   builder.setSupportsCustomSeparator(supportsCustomSeparator());
   builder.setSupportsSeparatorAnimation(supportsSeparatorAnimation());
   builder.setCustomSeparators(_separators);
   builder.setSeparatorAnimationEnabled(_animate_separator);
   builder.setSeparatorVisible(_separator_visible);
-  builder.setSkinConfigHash(_skin_cfg_hash);
-  builder.setGlyphScaleFactor(_k_base_size);
-  FormatDateTime(dt, _format, builder);
-  return builder.getLayout();
+  // only changed tokens are formatted, glyphs of others are just copied
+  _compiled_format.format(dt, _frame->lastDateTime(), builder);
+  auto res = _frame->update(dt);
+  return debug::decorate(std::move(res), _frame->layout());
+}
+
+std::optional<QRectF> ClassicSkin::changedRect() const
+{
+  return _frame->changedRect();
+}
+
+std::chrono::milliseconds ClassicSkin::updateInterval() const
+{
+  // separator blinks twice per second
+  if (_animate_separator)
+    return std::chrono::milliseconds(500);
+  return _compiled_format.updateInterval();
 }
 
 void ClassicSkin::setTokenTransform(QString token, QTransform transform)
@@ -346,14 +577,20 @@ void ClassicSkin::setTokenTransform(QString token, QTransform transform)
   handleConfigChange();
 }
 
-QTransform ClassicSkin::tokenTransform(const QString& token) const noexcept
+QTransform ClassicSkin::tokenTransform(QStringView token) const noexcept
 {
-  return _token_transform.value(token, QTransform());
+  // linear search, but usually there are only a few items,
+  // and no need to create QString (allocate memory) for lookup
+  for (auto iter = _token_transform.begin(); iter != _token_transform.end(); ++iter)
+    if (iter.key() == token)
+      return iter.value();
+  return QTransform();
 }
 
 void ClassicSkin::handleConfigChange()
 {
   ClassicSkinBase::handleConfigChange();
+  _frame->reset();
   configurationChanged();
 }
 
@@ -404,10 +641,11 @@ void ClassicSkinBase::updateConfigHash()
 
 std::shared_ptr<Resource> StaticText::process(QStringView str) const
 {
-  ClassicLayoutBuilder builder(_factory, *this);
-  builder.setSkinConfigHash(_skin_cfg_hash);
+  GlyphStacks stacks(_factory, *this, _skin_cfg_hash);
+  ClassicLayoutBuilder builder(stacks, *this, *_factory);
   builder.setGlyphScaleFactor(_k_base_size);
   const auto code_points = str.toUcs4();
-  for (auto c : code_points) builder.addCharacter(c);
-  return builder.getLayout();
+  for (auto c : code_points) builder.addGlyph({c});
+  auto layout = builder.getLayout();
+  return debug::decorate(builder.buildLayoutStack(layout), layout);
 }
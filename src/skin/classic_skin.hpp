@@ -13,6 +13,8 @@
 #include <QBrush>
 #include <QString>
 
+#include "datetime_formatter.hpp"
+#include "glyph_cache.hpp"
 #include "resource_factory.hpp"
 
 class ClassicSkinBase {
@@ -21,6 +23,7 @@ protected:  // TODO: move
     : _factory(std::move(factory))
   {
     updateConfigHash();   // to set default value
+    _glyph_cache->setAtlasEnabled(true);  // glyphs set is small
   }
 
 public:
@@ -99,17 +102,25 @@ public:
   void setLayoutConfig(QString layout_config);
   QString layoutConfig() const noexcept { return _layout_config; }
 
-  void setCachingEnabled(bool enable) noexcept { _caching_enabled = enable; }
-  inline void enableCaching() noexcept { setCachingEnabled(true); }
-  inline void disableCaching() noexcept { setCachingEnabled(false); }
+  void setCachingEnabled(bool enable)
+  {
+    _caching_enabled = enable;
+    handleConfigChange();
+  }
+  inline void enableCaching() { setCachingEnabled(true); }
+  inline void disableCaching() { setCachingEnabled(false); }
   bool cachingEnabled() const noexcept { return _caching_enabled; }
 
+  // rendered glyphs cache, owned by the skin, not shared with other skins
+  const std::shared_ptr<GlyphCache>& glyphCache() const noexcept { return _glyph_cache; }
+
 protected:
   virtual void handleConfigChange();
   void updateConfigHash();
 
 protected:  // TODO: make private
   std::shared_ptr<ResourceFactory> _factory;
+  std::shared_ptr<GlyphCache> _glyph_cache = std::make_shared<GlyphCache>();
   // public properties
   bool _supports_glyph_base_height = true;
   // effects configuration
@@ -143,12 +154,12 @@ public:
 
 class ClassicSkin final : public ClassicSkinBase, public Skin {
 public:
-  explicit ClassicSkin(std::shared_ptr<ResourceFactory> factory)
-    : ClassicSkinBase(std::move(factory))
-    , _format(QLatin1String("hh:mm a"))
-  {}
+  explicit ClassicSkin(std::shared_ptr<ResourceFactory> factory);
+  ~ClassicSkin();
 
   std::shared_ptr<Resource> process(const QDateTime& dt) override;
+  std::optional<QRectF> changedRect() const override;
+  std::chrono::milliseconds updateInterval() const override;
 
   void setSeparatorAnimationEnabled(bool enabled) override
   {
@@ -203,13 +214,14 @@ public:
     if (format.isEmpty() || format == _format)
       return;
     _format = std::move(format);
+    _compiled_format = CompiledDateTimeFormat(_format);
     handleConfigChange();
   }
 
   QString format() const noexcept { return _format; }
 
   void setTokenTransform(QString token, QTransform transform);
-  QTransform tokenTransform(const QString& token) const noexcept;
+  QTransform tokenTransform(QStringView token) const noexcept;
 
 protected:
   void handleConfigChange() override;
@@ -222,6 +234,10 @@ private:
   bool _animate_separator = true;
   bool _separator_visible = true;
   QString _format;
+  CompiledDateTimeFormat _compiled_format;
   QList<uint> _separators;
   QHash<QString, QTransform> _token_transform;
+  // layout built during the last process() call
+  class Frame;
+  std::unique_ptr<Frame> _frame;
 };
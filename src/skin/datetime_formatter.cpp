@@ -6,6 +6,8 @@
 
 #include "datetime_formatter.hpp"
 
+#include <array>
+
 #include <QLocale>
 
 namespace {
@@ -135,3 +137,387 @@ void FormatDateTime(const QDateTime& dt, QStringView sfmt,
     i += repeat - 1;
   }
 }
+
+CompiledDateTimeFormat::CompiledDateTimeFormat(QStringView fmt)
+{
+  const auto zero = QLocale::system().zeroDigit().toUcs4();
+  if (!zero.isEmpty())
+    _zero_digit = zero.front();
+  compile(fmt);
+}
+
+void CompiledDateTimeFormat::format(const QDateTime& dt, DateTimeStringBuilder& str_builder) const
+{
+  format(dt, QDateTime(), str_builder);
+}
+
+void CompiledDateTimeFormat::format(const QDateTime& dt, const QDateTime& prev,
+                                    DateTimeStringBuilder& str_builder) const
+{
+  const auto d = dt.date();
+  const auto t = dt.time();
+
+  for (const auto& ins : _program) {
+    const auto token = QStringView(_tokens).sliced(ins.token.pos, ins.token.len);
+    if (!token.isEmpty()) {
+      if (prev.isValid() && sameOutput(ins, dt, prev)) {
+        str_builder.tokenUnchanged(token);
+        continue;
+      }
+      str_builder.tokenStart(token);
+    }
+
+    switch (ins.op) {
+      case OpCode::Characters:
+        emitCharacters(ins.text, str_builder);
+        break;
+
+      case OpCode::Separator:
+        str_builder.addSeparator(_text[ins.text.pos]);
+        break;
+
+      case OpCode::Number: {
+        auto n = fieldValue(ins.field, d, t);
+        // QLocale handles years outside of [0, 9999] in its own way
+        if ((ins.field == Field::Year2 || ins.field == Field::Year4) && (n < 0 || n > 9999))
+          add_characters(QLocale::system().toString(dt, token), str_builder);
+        else
+          emitNumber(ins.field == Field::Year2 ? n % 100 : n, ins.width, str_builder);
+        break;
+      }
+
+      case OpCode::Text: {
+        auto idx = textIndex(ins.field, d, t);
+        if (0 <= idx && idx < ins.text.len)
+          emitCharacters(_names[ins.text.pos + idx], str_builder);
+        break;
+      }
+
+      case OpCode::LocaleText:
+        add_characters(QLocale::system().toString(dt, token), str_builder);
+        break;
+    }
+
+    if (!token.isEmpty())
+      str_builder.tokenEnd(token);
+  }
+}
+
+// mirrors FormatDateTime() parsing logic
+void CompiledDateTimeFormat::compile(QStringView sfmt)
+{
+  const auto fp = sfmt.toUcs4();
+  const std::vector<char32_t> fmt(fp.begin(), fp.end());
+
+  bool escaped = false;
+  bool quoted = false;
+
+  for (qsizetype i = 0; i < fmt.size(); ++i) {
+    const auto& c = fmt[i];
+
+    if (escaped) {
+      escaped = false;
+      const auto ec = escape_char(c);
+      addCharacters(QString::fromUcs4(&ec, 1));
+      continue;
+    }
+
+    if (c == '\\') {
+      escaped = true;
+      continue;
+    }
+
+    if (c == '\'') {
+      quoted = !quoted;
+      continue;
+    }
+
+    if (quoted) {
+      addCharacters(QString::fromUcs4(&c, 1));
+      continue;
+    }
+
+    int repeat = repeat_count(i, fmt);
+
+    switch (c) {
+      case 'h':
+        repeat = qMin(repeat, 2);
+        addNumber(Field::Hour12, repeat == 2 ? 2 : 0, QString(repeat, QChar(c)));
+        break;
+      case 'J':
+        repeat = qMin(repeat, 1);
+        addNumber(Field::DayOfYear, 0, QString(repeat, QChar(c)));
+        break;
+      case 'W':
+        repeat = qMin(repeat, 2);
+        addNumber(Field::WeekNumber, repeat == 2 ? 2 : 0, QString(repeat, QChar(c)));
+        break;
+      case ':':
+        addSeparator(c);
+        break;
+      case 'a':
+      case 'A':
+        repeat = qMin(repeat, 1);
+        if (i + 1 < fmt.size() && (fmt[i+1] == 'p' || fmt[i+1] == 'P'))
+          repeat += 1;  // AP should be handled as 'A' (case insensitive)
+        addText(Field::AmPm, QString::fromUcs4(&fmt[i], repeat));
+        break;
+      default: {
+        const auto token = QString::fromUcs4(&fmt[i], repeat);
+        // only tokens with well-known meaning are compiled,
+        // anything else is handled by QLocale as before
+        switch (c) {
+          case 'H':
+            if (repeat <= 2)
+              addNumber(Field::Hour24, repeat == 2 ? 2 : 0, token);
+            else
+              addLocaleText(token);
+            break;
+          case 'm':
+            if (repeat <= 2)
+              addNumber(Field::Minute, repeat == 2 ? 2 : 0, token);
+            else
+              addLocaleText(token);
+            break;
+          case 's':
+            if (repeat <= 2)
+              addNumber(Field::Second, repeat == 2 ? 2 : 0, token);
+            else
+              addLocaleText(token);
+            break;
+          case 'd':
+          case 'M':
+            if (repeat > 4)
+              addLocaleText(token);
+            else if (repeat > 2)
+              addText(c == 'd' ? Field::DayOfWeek : Field::Month, token);
+            else
+              addNumber(c == 'd' ? Field::Day : Field::Month, repeat == 2 ? 2 : 0, token);
+            break;
+          case 'y':
+            if (repeat == 2)
+              addNumber(Field::Year2, 2, token);
+            else if (repeat == 4)
+              addNumber(Field::Year4, 4, token);
+            else
+              addLocaleText(token);
+            break;
+          case 'z':
+          case 't':
+          case 'P':
+          case 'p':
+            addLocaleText(token);
+            break;
+          default: {
+            // not a pattern character, output doesn't depend on date/time
+            const QDateTime ref_dt(QDate(2000, 1, 1), QTime(0, 0));
+            addCharacters(QLocale::system().toString(ref_dt, token), token);
+          }
+        }
+      }
+    }
+
+    i += repeat - 1;
+  }
+}
+
+void CompiledDateTimeFormat::addCharacters(QStringView chars, QStringView token)
+{
+  // merge subsequent characters into one instruction
+  if (token.isEmpty() && !_program.empty()) {
+    auto& last = _program.back();
+    if (last.op == OpCode::Characters && last.token.len == 0 &&
+        last.text.pos + last.text.len == static_cast<qsizetype>(_text.size())) {
+      last.text.len += storeText(chars).len;
+      return;
+    }
+  }
+
+  Instruction ins{OpCode::Characters};
+  ins.text = storeText(chars);
+  if (!token.isEmpty())
+    ins.token = storeToken(token);
+  _program.push_back(ins);
+}
+
+void CompiledDateTimeFormat::addSeparator(char32_t c)
+{
+  Instruction ins{OpCode::Separator};
+  ins.text = storeText(QString::fromUcs4(&c, 1));
+  _program.push_back(ins);
+}
+
+void CompiledDateTimeFormat::addNumber(Field field, int width, QStringView token)
+{
+  Instruction ins{OpCode::Number};
+  ins.field = field;
+  ins.width = static_cast<quint8>(width);
+  ins.token = storeToken(token);
+  _program.push_back(ins);
+}
+
+void CompiledDateTimeFormat::addText(Field field, QStringView token)
+{
+  const auto& locale = QLocale::system();
+  std::vector<QString> names;
+
+  switch (field) {
+    case Field::DayOfWeek:
+      // 2024-01-01 is Monday
+      for (int i = 1; i <= 7; i++)
+        names.push_back(locale.toString(QDate(2024, 1, i), token));
+      break;
+    case Field::Month:
+      for (int i = 1; i <= 12; i++)
+        names.push_back(locale.toString(QDate(2024, i, 1), token));
+      break;
+    case Field::AmPm:
+      names.push_back(locale.toString(QTime(1, 0), token));
+      names.push_back(locale.toString(QTime(13, 0), token));
+      break;
+    default:
+      Q_UNREACHABLE();
+  }
+
+  Instruction ins{OpCode::Text};
+  ins.field = field;
+  ins.text = {static_cast<qsizetype>(_names.size()), static_cast<qsizetype>(names.size())};
+  for (const auto& name : names)
+    _names.push_back(storeText(name));
+  ins.token = storeToken(token);
+  _program.push_back(ins);
+}
+
+void CompiledDateTimeFormat::addLocaleText(QStringView token)
+{
+  Instruction ins{OpCode::LocaleText};
+  ins.token = storeToken(token);
+  _program.push_back(ins);
+}
+
+CompiledDateTimeFormat::Span CompiledDateTimeFormat::storeToken(QStringView token)
+{
+  Span s{_tokens.size(), token.size()};
+  _tokens.append(token);
+  ++_tokens_count;
+  return s;
+}
+
+CompiledDateTimeFormat::Span CompiledDateTimeFormat::storeText(QStringView text)
+{
+  const auto code_points = text.toUcs4();
+  Span s{static_cast<qsizetype>(_text.size()), code_points.size()};
+  _text.insert(_text.end(), code_points.begin(), code_points.end());
+  return s;
+}
+
+int CompiledDateTimeFormat::fieldValue(Field field, QDate d, QTime t) noexcept
+{
+  switch (field) {
+    case Field::None:
+      return 0;
+    case Field::Hour12: {
+      auto h = t.hour();
+      if (h == 0) h = 12;
+      return h > 12 ? h - 12 : h;
+    }
+    case Field::Hour24:
+      return t.hour();
+    case Field::Minute:
+      return t.minute();
+    case Field::Second:
+      return t.second();
+    case Field::Day:
+      return d.day();
+    case Field::DayOfWeek:
+      return d.dayOfWeek() - 1;
+    case Field::DayOfYear:
+      return d.dayOfYear();
+    case Field::WeekNumber:
+      return d.weekNumber();
+    case Field::Month:
+      return d.month();
+    case Field::Year2:
+    case Field::Year4:
+      return d.year();
+    case Field::AmPm:
+      return t.hour() < 12 ? 0 : 1;
+  }
+  return 0;
+}
+
+int CompiledDateTimeFormat::textIndex(Field field, QDate d, QTime t) noexcept
+{
+  // month names are 0-based, but month number is 1-based
+  if (field == Field::Month)
+    return d.month() - 1;
+  return fieldValue(field, d, t);
+}
+
+std::chrono::milliseconds CompiledDateTimeFormat::updateInterval() const noexcept
+{
+  using namespace std::chrono_literals;
+  for (const auto& ins : _program) {
+    // nothing is known about QLocale-handled tokens, assume seconds precision
+    if (ins.op == OpCode::LocaleText)
+      return 1s;
+    if ((ins.op == OpCode::Number || ins.op == OpCode::Text) && ins.field == Field::Second)
+      return 1s;
+  }
+  // any date change is a minute change too
+  return 1min;
+}
+
+bool CompiledDateTimeFormat::sameOutput(const Instruction& ins, const QDateTime& dt, const QDateTime& prev)
+{
+  switch (ins.op) {
+    case OpCode::Characters:
+    case OpCode::Separator:
+      return true;
+
+    case OpCode::Number:
+      return fieldValue(ins.field, dt.date(), dt.time()) ==
+             fieldValue(ins.field, prev.date(), prev.time());
+
+    case OpCode::Text:
+      return textIndex(ins.field, dt.date(), dt.time()) ==
+             textIndex(ins.field, prev.date(), prev.time());
+
+    case OpCode::LocaleText:
+      // nothing is known about such tokens
+      return dt == prev;
+  }
+  return false;
+}
+
+void CompiledDateTimeFormat::emitNumber(int n, int width, DateTimeStringBuilder& str_builder) const
+{
+  // enough for any int, digits are in reverse order
+  std::array<char32_t, 16> digits;
+  int count = 0;
+  bool negative = n < 0;
+  unsigned int u = negative ? 0u - static_cast<unsigned int>(n) : static_cast<unsigned int>(n);
+  do {
+    digits[count++] = _zero_digit + u % 10;
+    u /= 10;
+  } while (u != 0);
+
+  if (negative)
+    str_builder.addCharacter('-');
+  for (int i = count; i < width; i++)
+    str_builder.addCharacter(_zero_digit);
+  while (count > 0)
+    str_builder.addCharacter(digits[--count]);
+}
+
+void CompiledDateTimeFormat::emitCharacters(Span text, DateTimeStringBuilder& str_builder) const
+{
+  for (auto i = text.pos; i < text.pos + text.len; i++)
+    str_builder.addCharacter(_text[i]);
+}
+
+void FormatDateTime(const QDateTime& dt, const CompiledDateTimeFormat& fmt,
+                    DateTimeStringBuilder& str_builder)
+{
+  fmt.format(dt, str_builder);
+}
@@ -6,7 +6,11 @@
 
 #pragma once
 
+#include <chrono>
+#include <vector>
+
 #include <QDateTime>
+#include <QString>
 #include <QStringView>
 
 class DateTimeStringBuilder {
@@ -18,8 +22,112 @@ public:
 
   virtual void tokenStart(QStringView token) {}
   virtual void tokenEnd(QStringView token) {}
+
+  // called instead of tokenStart()/tokenEnd() pair when token output
+  // is known to be the same as on the previous formatting call,
+  // see CompiledDateTimeFormat::format() with previous date/time
+  virtual void tokenUnchanged(QStringView token) {}
 };
 
 // in format string only ':' is considered as separator
 void FormatDateTime(const QDateTime& dt, QStringView fmt,
                     DateTimeStringBuilder& str_builder);
+
+/**
+ * @brief Pre-parsed format string
+ *
+ * Format string is parsed only once into a flat list of instructions,
+ * applying it to any date/time doesn't allocate memory (except rare
+ * tokens which can be handled only by QLocale).
+ *
+ * Produces exactly the same output as FormatDateTime() with the same
+ * format string. Locale-dependent texts (digits, names, AM/PM) are taken
+ * from the system locale at construction time.
+ */
+class CompiledDateTimeFormat final {
+public:
+  CompiledDateTimeFormat() = default;
+  explicit CompiledDateTimeFormat(QStringView fmt);
+
+  void format(const QDateTime& dt, DateTimeStringBuilder& str_builder) const;
+  // formats only tokens changed since @a prev, for other tokens only
+  // DateTimeStringBuilder::tokenUnchanged() is called, characters
+  // outside of tokens and separators are always reported
+  void format(const QDateTime& dt, const QDateTime& prev,
+              DateTimeStringBuilder& str_builder) const;
+
+  // how many tokens are in format string
+  qsizetype tokensCount() const noexcept { return _tokens_count; }
+
+  // the smallest time interval which may change the output
+  std::chrono::milliseconds updateInterval() const noexcept;
+
+private:
+  enum class OpCode : quint8 {
+    Characters,     // just a list of characters, may be a token
+    Separator,      // single separator character
+    Number,         // numeric field with padding
+    Text,           // text selected from the names table
+    LocaleText,     // formatted by QLocale, may allocate memory
+  };
+
+  enum class Field : quint8 {
+    None,
+    Hour12,
+    Hour24,
+    Minute,
+    Second,
+    Day,
+    DayOfWeek,
+    DayOfYear,
+    WeekNumber,
+    Month,
+    Year2,
+    Year4,
+    AmPm,
+  };
+
+  // just a range in some storage
+  struct Span {
+    qsizetype pos = 0;
+    qsizetype len = 0;
+  };
+
+  struct Instruction {
+    OpCode op;
+    Field field = Field::None;
+    quint8 width = 0;     // minimal width (number) / characters count
+    Span text;            // characters or names table range
+    Span token;           // token name, empty if no token
+  };
+
+  void compile(QStringView fmt);
+
+  void addCharacters(QStringView chars, QStringView token = {});
+  void addSeparator(char32_t c);
+  void addNumber(Field field, int width, QStringView token);
+  void addText(Field field, QStringView token);
+  void addLocaleText(QStringView token);
+
+  Span storeToken(QStringView token);
+  Span storeText(QStringView text);
+
+  static int fieldValue(Field field, QDate d, QTime t) noexcept;
+  // index in names table built by addText()
+  static int textIndex(Field field, QDate d, QTime t) noexcept;
+  static bool sameOutput(const Instruction& ins, const QDateTime& dt, const QDateTime& prev);
+
+  void emitNumber(int n, int width, DateTimeStringBuilder& str_builder) const;
+  void emitCharacters(Span text, DateTimeStringBuilder& str_builder) const;
+
+private:
+  std::vector<Instruction> _program;
+  std::vector<char32_t> _text;    // all characters and names
+  std::vector<Span> _names;       // names tables
+  QString _tokens;                // all tokens names, one after another
+  qsizetype _tokens_count = 0;
+  char32_t _zero_digit = '0';
+};
+
+void FormatDateTime(const QDateTime& dt, const CompiledDateTimeFormat& fmt,
+                    DateTimeStringBuilder& str_builder);
@@ -0,0 +1,50 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "effects_stack.hpp"
+
+#include "effects.hpp"
+
+namespace {
+
+template<class Effect>
+std::shared_ptr<Resource> createEffect(const std::shared_ptr<FrameArena>& arena,
+                                       std::shared_ptr<Resource> inner, QBrush b, bool stretch)
+{
+  auto effect = makeShared<Effect>(arena, std::move(inner));
+  effect->setBrush(std::move(b));
+  effect->setStretch(stretch);
+  return effect;
+}
+
+} // namespace
+
+std::shared_ptr<Resource> buildEffectsStack(const std::shared_ptr<FrameArena>& arena,
+                                            std::shared_ptr<Resource> g,
+                                            std::pair<QBrush, bool> tx_cfg,
+                                            std::pair<QBrush, bool> bg_cfg)
+{
+  auto [bg, bg_stretch] = std::move(bg_cfg);
+  auto [tx, tx_stretch] = std::move(tx_cfg);
+
+  if (bg.style() == Qt::NoBrush && tx.style() == Qt::NoBrush) {
+    // do nothing
+  }
+  if (bg.style() != Qt::NoBrush && tx.style() == Qt::NoBrush) {
+    g = createEffect<BackgroundDecorator>(arena, std::move(g), std::move(bg), bg_stretch);
+  }
+  if (bg.style() == Qt::NoBrush && tx.style() != Qt::NoBrush) {
+    g = createEffect<TexturingDecorator>(arena, std::move(g), std::move(tx), tx_stretch);
+    g = makeShared<NewSurfaceDecorator>(arena, std::move(g));
+  }
+  if (bg.style() != Qt::NoBrush && tx.style() != Qt::NoBrush) {
+    g = createEffect<TexturingDecorator>(arena, std::move(g), std::move(tx), tx_stretch);
+    g = makeShared<NewSurfaceDecorator>(arena, std::move(g));
+    g = createEffect<BackgroundDecorator>(arena, std::move(g), std::move(bg), bg_stretch);
+  }
+
+  return g;
+}
@@ -0,0 +1,23 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <memory>
+#include <utility>
+
+#include <QBrush>
+
+#include "frame_arena.hpp"
+#include "resource.hpp"
+
+// skin-internal helper, wraps given resource into texture/background effects
+// the same way as classic skins do, each config is a brush and stretch flag,
+// Qt::NoBrush means that effect is not applied
+std::shared_ptr<Resource> buildEffectsStack(const std::shared_ptr<FrameArena>& arena,
+                                            std::shared_ptr<Resource> g,
+                                            std::pair<QBrush, bool> tx_cfg,
+                                            std::pair<QBrush, bool> bg_cfg);
@@ -10,9 +10,15 @@
 #include <array>
 #include <functional>
 #include <ranges>
+#include <string_view>
 
+#include <QFile>
 #include <QFileInfo>
+#include <QImageReader>
+#include <QRegularExpression>
 #include <QSettings>
+#include <QThreadPool>
+#include <QXmlStreamReader>
 
 #include "image_resource.hpp"
 
@@ -158,16 +164,58 @@ std::shared_ptr<ImageResource> createResource(const QString& path)
   return nullptr;
 }
 
-void updateGeometry(ImageResource& item, const GlyphGeometryRaw& gargs)
+// reads only root element attributes, doesn't parse the whole document,
+// result is the same as QSvgRenderer::defaultSize() for simple cases,
+// std::nullopt is returned if it can't be determined such way
+std::optional<QSize> svgDefaultSize(const QString& path)
 {
-  const auto& r = item.rect();
-  qreal x = gargs.x.value_or(r.x());
-  qreal y = gargs.y.value_or(r.y());
-  qreal w = gargs.w.value_or(r.width());
-  qreal h = gargs.h.value_or(r.height());
-  qreal ax = gargs.ax.value_or(w);
-  qreal ay = gargs.ay.value_or(h);
-  item.setGeometry({x, y, w, h}, ax, ay);
+  QFile f(path);
+  if (!f.open(QIODevice::ReadOnly))
+    return std::nullopt;
+
+  QXmlStreamReader xml(&f);
+  while (!xml.atEnd() && xml.readNext() != QXmlStreamReader::StartElement) {}
+  if (xml.name() != "svg"_L1)
+    return std::nullopt;
+
+  // only user units (px) are supported
+  auto length = [](QStringView s) -> std::optional<qreal> {
+    s = s.trimmed();
+    if (s.endsWith("px"_L1)) s.chop(2);
+    bool ok = false;
+    qreal v = s.toDouble(&ok);
+    return ok ? std::optional(v) : std::nullopt;
+  };
+
+  const auto attrs = xml.attributes();
+  if (attrs.hasAttribute("width"_L1) || attrs.hasAttribute("height"_L1)) {
+    auto w = length(attrs.value("width"_L1));
+    auto h = length(attrs.value("height"_L1));
+    return w && h ? std::optional(QSizeF(*w, *h).toSize()) : std::nullopt;
+  }
+
+  static const QRegularExpression separators(u"[\\s,]+"_s);
+  const auto view_box = attrs.value("viewBox"_L1).toString().split(separators, Qt::SkipEmptyParts);
+  if (view_box.size() != 4)
+    return std::nullopt;
+  auto w = length(view_box[2]);
+  auto h = length(view_box[3]);
+  return w && h ? std::optional(QSizeF(*w, *h).toSize()) : std::nullopt;
+}
+
+// glyph size without loading it
+std::optional<QSize> imageSize(const QString& path)
+{
+  QString ext = QFileInfo(path).suffix().toLower();
+
+  if (ext == "svg")
+    return svgDefaultSize(path);
+
+  if (ext == "png")
+    if (auto sz = QImageReader(path).size(); sz.isValid())
+      return sz;
+
+  return std::nullopt;
 }
 
 } // namespace
@@ -176,15 +224,53 @@ ImageResourceFactory::ImageResourceFactory(const SkinFilesMap& files)
 {
   for (auto iter = files.begin(); iter != files.end(); ++iter) {
     const auto& [file, gargs] = iter.value();
-    auto resource = createResource(file);
-    if (resource) {
-      updateGeometry(*resource, gargs);
-      _min_y = std::min(_min_y, resource->rect().top());
-      _max_y = std::max(_max_y, resource->rect().bottom());
+    GlyphInfo info;
+    std::shared_ptr<ImageResource> loaded;
+
+    QRectF r;
+    if (gargs.x && gargs.y && gargs.w && gargs.h) {
+      // geometry is completely defined by skin, nothing to read
+      info.file = file;
+      r = QRectF(*gargs.x, *gargs.y, *gargs.w, *gargs.h);
+    } else if (auto sz = imageSize(file)) {
+      info.file = file;
+      r = QRectF(QPointF(gargs.x.value_or(0), gargs.y.value_or(0)),
+                 QSizeF(gargs.w.value_or(sz->width()), gargs.h.value_or(sz->height())));
+    } else if (auto resource = createResource(file)) {
+      // size can't be determined without loading, so load it now
+      const auto& ir = resource->rect();
+      r = QRectF(gargs.x.value_or(ir.x()), gargs.y.value_or(ir.y()),
+                 gargs.w.value_or(ir.width()), gargs.h.value_or(ir.height()));
+      info.file = file;
+      loaded = std::move(resource);
+    }
+
+    if (!info.file.isEmpty()) {
+      info.rect = r;
+      info.ax = gargs.ax.value_or(r.width());
+      info.ay = gargs.ay.value_or(r.height());
+      if (loaded) {
+        loaded->setGeometry(info.rect, info.ax, info.ay);
+        info.resource = std::move(loaded);
+      }
+      _min_y = std::min(_min_y, r.top());
+      _max_y = std::max(_max_y, r.bottom());
     }
-    _resources[iter.key()] = resource;
+    _glyphs[iter.key()] = std::move(info);
   }
-  _has_2_seps = _resources.contains(':') && _resources.contains(' ');
+  _has_2_seps = _glyphs.contains(':') && _glyphs.contains(' ');
+}
+
+void ImageResourceFactory::prefetch(std::shared_ptr<ImageResourceFactory> factory,
+                                    QList<qreal> scales)
+{
+  QThreadPool::globalInstance()->start([factory = std::move(factory), scales = std::move(scales)]() {
+    for (char32_t ch : std::u32string_view(U"0123456789: ")) {
+      auto resource = factory->item(ch);
+      if (auto svg = std::dynamic_pointer_cast<SvgImageResource>(resource); svg && !scales.isEmpty())
+        svg->warmUp(scales);
+    }
+  });
 }
 
 std::shared_ptr<Resource> ImageResourceFactory::create(char32_t c) const
@@ -196,8 +282,19 @@ std::shared_ptr<Resource> ImageResourceFactory::create(char32_t c) const
     ch = ' ';
   if (!_has_2_seps && ch == ' ')
     ch = ':';
-  auto iter = _resources.find(ch.toLower());
-  return iter != _resources.end() ? iter.value() : nullptr;
+  auto iter = _glyphs.find(ch.toLower());
+  if (iter == _glyphs.end() || iter->file.isEmpty())
+    return nullptr;
+
+  // called under factory lock, so it is safe to modify cached resource
+  const auto& info = iter.value();
+  if (!info.resource) {
+    auto resource = createResource(info.file);
+    if (resource)
+      resource->setGeometry(info.rect, info.ax, info.ay);
+    info.resource = std::move(resource);
+  }
+  return info.resource;
 }
 
 
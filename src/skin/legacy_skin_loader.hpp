@@ -26,6 +26,8 @@ struct GlyphGeometryRaw {
 using SkinFileInfo = QPair<QString, GlyphGeometryRaw>;
 using SkinFilesMap = QHash<QChar, SkinFileInfo>;
 
+// glyphs are loaded only when requested for the first time,
+// only file paths and geometry are known after construction
 class ImageResourceFactory final : public ResourceFactory {
 public:
   explicit ImageResourceFactory(const SkinFilesMap& files);
@@ -35,11 +37,25 @@ public:
   qreal ascent() const noexcept override { return -_min_y; }
   qreal descent() const noexcept override { return _max_y; }
 
+  // loads glyphs used by any format (digits and separators) in background,
+  // vector glyphs are also pre-rendered for given device scales
+  static void prefetch(std::shared_ptr<ImageResourceFactory> factory,
+                       QList<qreal> scales = {});
+
 protected:
   std::shared_ptr<Resource> create(char32_t ch) const override;
 
 private:
-  QHash<QChar, std::shared_ptr<Resource>> _resources;
+  struct GlyphInfo {
+    QString file;
+    QRectF rect;
+    qreal ax = 0;
+    qreal ay = 0;
+    // loaded resource, shared by all characters mapped to this glyph
+    mutable std::shared_ptr<Resource> resource;
+  };
+
+  QHash<QChar, GlyphInfo> _glyphs;
   bool _has_2_seps = false;
   qreal _min_y = 0;
   qreal _max_y = 0;
@@ -58,14 +74,20 @@ public:
     if (!valid())
       return nullptr;
 
-    auto factory = std::make_unique<ImageResourceFactory>(_files);
+    auto factory = std::make_shared<ImageResourceFactory>(_files);
     bool supports_separator_animation = factory->supportsSeparatorAnimation();
+    if (_prefetch) ImageResourceFactory::prefetch(factory, _warm_up_scales);
     auto skin = std::make_unique<ClassicSkin>(std::move(factory));
     skin->setSupportsGlyphBaseHeight(true);
     skin->setSupportsSeparatorAnimation(supports_separator_animation);
     return skin;
   }
 
+  // start glyphs loading in background when skin is created
+  void setPrefetchEnabled(bool enabled) noexcept { _prefetch = enabled; }
+  // device scales to pre-render vector glyphs for during prefetch
+  void setWarmUpScales(QList<qreal> scales) { _warm_up_scales = std::move(scales); }
+
 private:
   void init(const QString& skin_root);
 
@@ -74,4 +96,6 @@ private:
 
 private:
   SkinFilesMap _files;
+  bool _prefetch = false;
+  QList<qreal> _warm_up_scales;
 };
@@ -15,11 +15,13 @@
 #include <QJsonObject>
 
 #include "classic_skin.hpp"
+#include "display_list.hpp"
 #include "effects.hpp"
 #include "font_resource.hpp"
 #include "image_resource.hpp"
 #include "legacy_skin_loader.hpp"
 #include "layout.hpp"
+#include "layout_debug.hpp"
 #include "linear_layout.hpp"
 
 namespace {
@@ -79,10 +81,12 @@ public:
     : SkinItem(std::make_shared<SkinResource>(std::move(skin), dt))
   {}
 
+  // geometry is only invalidated, the whole layout
+  // is updated once when all items are processed
   void process(const QDateTime& dt)
   {
     _res->process(dt);
-    updateGeometry();
+    invalidateGeometry();
   }
 
   std::shared_ptr<Skin> skin() const noexcept { return _res->skin(); }
@@ -102,6 +106,13 @@ private:
 
     size_t cacheKey() const override { return _res->cacheKey(); }
 
+    // drawn exactly as the skin's resource
+    bool record(DisplayListRecorder& r) const override
+    {
+      r.add(_res, QTransform());
+      return true;
+    }
+
     void process(const QDateTime& dt) { _res = _skin->process(dt); }
 
     std::shared_ptr<Skin> skin() const noexcept { return _skin; }
@@ -122,14 +133,27 @@ private:
 };
 
 
+// item must be decorated by this effect, it is notified about visibility
+// changes, so cached data of its parents is invalidated
 class VisibilityEffect final : public Effect {
 public:
+  explicit VisibilityEffect(std::weak_ptr<LayoutItem> item) noexcept
+    : _item(std::move(item))
+  {}
+
   ResourcePtr decorate(ResourcePtr res) override
   {
     return std::make_shared<Decorator>(*this, std::move(res));
   }
 
-  void setVisible(bool visible) noexcept { _visible = visible; }
+  void setVisible(bool visible) noexcept
+  {
+    if (visible == _visible) return;
+    _visible = visible;
+    if (auto item = _item.lock())
+      item->invalidateContent();
+  }
+
   bool isVisible() const noexcept { return _visible; }
 
 private:
@@ -146,10 +170,19 @@ private:
         ResourceDecorator::draw(p);
     }
 
+    // hidden and visible states are different content,
+    // not cacheable content stays not cacheable
+    size_t cacheKey() const override
+    {
+      const auto key = ResourceDecorator::cacheKey();
+      return key == size_t(-1) ? key : qHashMulti(key, _effect.isVisible());
+    }
+
   private:
     const VisibilityEffect& _effect;
   };
 
+  std::weak_ptr<LayoutItem> _item;
   bool _visible = true;
 };
 
@@ -512,7 +545,8 @@ public:
   std::shared_ptr<Resource> process(const QDateTime& dt)
   {
     for (const auto& i : std::as_const(_items)) i->process(dt);
-    return _layout->resource();
+    _layout->updateGeometry();
+    return debug::decorate(_layout->resource(), _layout);
   }
 
   void setSeparatorAnimationEnabled(bool enabled)
@@ -524,6 +558,17 @@ public:
     _animate_separator = enabled;
   }
 
+  std::chrono::milliseconds updateInterval() const
+  {
+    using namespace std::chrono_literals;
+    if (_animate_separator && !_seps.isEmpty())
+      return 500ms;
+    std::chrono::milliseconds interval = 1min;
+    for (const auto& item : std::as_const(_items))
+      interval = std::min(interval, item->skin()->updateInterval());
+    return interval;
+  }
+
   void animateSeparator()
   {
     for (const auto& item : std::as_const(_items))
@@ -782,7 +827,7 @@ private:
   void applyCommonItemOptions(const QJsonObject& js, LayoutItem& item) const
   {
     if (const auto v = js["is_separator"]; v.isBool() && v.toBool()) {
-      auto veffect = std::make_shared<VisibilityEffect>();
+      auto veffect = std::make_shared<VisibilityEffect>(item.weak_from_this());
       item.decorate(veffect);
       _seps.insert(std::move(veffect));
     }
@@ -861,6 +906,11 @@ std::shared_ptr<Resource> ModernSkin::process(const QDateTime& dt)
   return _impl->process(dt);
 }
 
+std::chrono::milliseconds ModernSkin::updateInterval() const
+{
+  return _impl->updateInterval();
+}
+
 void ModernSkin::setSeparatorAnimationEnabled(bool enabled)
 {
   _impl->setSeparatorAnimationEnabled(enabled);
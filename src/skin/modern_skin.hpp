@@ -16,6 +16,7 @@ public:
   ~ModernSkin();
 
   std::shared_ptr<Resource> process(const QDateTime& dt) override;
+  std::chrono::milliseconds updateInterval() const override;
 
   void setSeparatorAnimationEnabled(bool enabled) override;
   void animateSeparator() override;
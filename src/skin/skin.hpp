@@ -6,9 +6,12 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <optional>
 
 #include <QDateTime>
+#include <QRectF>
 
 #include "resource.hpp"
 #include "observable.hpp"
@@ -27,6 +30,14 @@ public:
 
   virtual std::shared_ptr<Resource> process(const QDateTime& dt) = 0;
 
+  // area changed by the last process() call, in coordinates of the returned resource
+  // std::nullopt means "unknown", everything should be considered as changed
+  virtual std::optional<QRectF> changedRect() const { return std::nullopt; }
+
+  // output may change only at multiples of this interval (since the epoch),
+  // used to schedule updates, default value is suitable for any skin
+  virtual std::chrono::milliseconds updateInterval() const { return std::chrono::milliseconds(500); }
+
   virtual void setSeparatorAnimationEnabled(bool enabled) = 0;
   inline void EnableSeparatorAnimation() { setSeparatorAnimationEnabled(true); }
   inline void DisableSeparatorAnimation() { setSeparatorAnimationEnabled(false); }
@@ -0,0 +1,458 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+// rendering pipeline benchmarks
+//
+// besides usual QBENCHMARK output, each benchmark prints ns/op and
+// allocations/op measured over fixed number of iterations
+//
+// only C++ operator new calls are counted as allocations, memory
+// allocated directly with malloc() (e.g. QImage or Qt containers data)
+// is not counted
+//
+// environment variables:
+//   BENCH_RENDER_OUTPUT     - save results to given CSV file
+//   BENCH_RENDER_BASELINE   - compare results with given CSV file
+//   BENCH_RENDER_TOLERANCE  - allowed slowdown, 0.25 (25%) by default
+
+#include <QTest>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QLinearGradient>
+#include <QPainter>
+
+#include "classic_skin.hpp"
+#include "datetime_formatter.hpp"
+#include "effects_stack.hpp"
+#include "font_resource.hpp"
+#include "glyph_cache.hpp"
+#include "legacy_skin_loader.hpp"
+#include "linear_layout.hpp"
+#include "modern_skin_loader.hpp"
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace {
+
+std::atomic<quint64> g_allocations = 0;
+
+} // namespace
+
+// count all C++ allocations, from any thread
+void* operator new(std::size_t sz)
+{
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(sz ? sz : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+struct Measurement {
+  qreal ns_per_op = 0;
+  qreal allocs_per_op = 0;
+};
+
+template<typename F>
+Measurement measure(F&& f, int iterations)
+{
+  f();  // warm-up
+  const auto allocs = g_allocations.load();
+  QElapsedTimer timer;
+  timer.start();
+  for (int i = 0; i < iterations; i++) f();
+  const auto ns = timer.nsecsElapsed();
+  return {qreal(ns) / iterations, qreal(g_allocations.load() - allocs) / iterations};
+}
+
+QImage makeTarget(QSize sz, qreal dpr = 1.0)
+{
+  QImage img(sz * dpr, QImage::Format_ARGB32_Premultiplied);
+  img.setDevicePixelRatio(dpr);
+  img.fill(Qt::transparent);
+  return img;
+}
+
+void drawFrame(QImage& img, Resource& res)
+{
+  img.fill(Qt::transparent);
+  QPainter p(&img);
+  p.setRenderHint(QPainter::Antialiasing);
+  p.setRenderHint(QPainter::SmoothPixmapTransform);
+  p.translate(-res.rect().topLeft());
+  res.draw(&p);
+}
+
+std::shared_ptr<Skin> createSkin(const QString& type)
+{
+  const QDir skins_dir(QStringLiteral(BENCH_SKINS_DIR));
+  if (type == u"font"_s) {
+    QFont fnt(u"Sans"_s, 48);
+    return std::make_shared<ClassicSkin>(std::make_shared<FontResourceFactory>(fnt));
+  }
+  if (type == u"legacy"_s)
+    return LegacySkinLoader(skins_dir.absoluteFilePath(u"electronic"_s)).skin();
+  if (type == u"modern"_s)
+    return ModernSkinLoader(skins_dir.absoluteFilePath(u"dseg"_s)).skin();
+  return nullptr;
+}
+
+} // namespace
+
+class RenderBenchmark : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+
+  void formatDateTime_data();
+  void formatDateTime();
+  void skinProcess_data();
+  void skinProcess();
+  void skinRebuild_data();
+  void skinRebuild();
+  void linearLayout_data();
+  void linearLayout();
+  void multiLineLayout_data();
+  void multiLineLayout();
+  void cachedResource_data();
+  void cachedResource();
+  void effectsStack_data();
+  void effectsStack();
+  void offscreenFrame_data();
+  void offscreenFrame();
+
+private:
+  // measures given operation, then runs QBENCHMARK for it
+  template<typename F>
+  void run(F&& f, int iterations = 1000)
+  {
+    const auto m = measure(f, iterations);
+    const auto name = QStringLiteral("%1/%2").arg(QTest::currentTestFunction(), QTest::currentDataTag());
+    qInfo("%s: %.1f ns/op, %.2f allocs/op", qUtf8Printable(name), m.ns_per_op, m.allocs_per_op);
+    _results[name] = m;
+
+    QBENCHMARK {
+      f();
+    }
+  }
+
+  static QHash<QString, Measurement> loadResults(const QString& filename);
+  static void saveResults(const QString& filename, const QHash<QString, Measurement>& results);
+
+private:
+  QHash<QString, Measurement> _results;
+  QDateTime _dt;
+};
+
+void RenderBenchmark::initTestCase()
+{
+  _dt = QDateTime(QDate(2024, 3, 1), QTime(12, 30, 56));
+  qInfo("allocs/op counts only C++ operator new calls, malloc() calls are not counted");
+}
+
+void RenderBenchmark::cleanupTestCase()
+{
+  if (auto out = qEnvironmentVariable("BENCH_RENDER_OUTPUT"); !out.isEmpty())
+    saveResults(out, _results);
+
+  const auto baseline_file = qEnvironmentVariable("BENCH_RENDER_BASELINE");
+  if (baseline_file.isEmpty())
+    return;
+
+  bool ok = false;
+  qreal tolerance = qEnvironmentVariable("BENCH_RENDER_TOLERANCE").toDouble(&ok);
+  if (!ok) tolerance = 0.25;
+
+  const auto baseline = loadResults(baseline_file);
+  QStringList regressions;
+  for (auto iter = _results.cbegin(); iter != _results.cend(); ++iter) {
+    auto b = baseline.find(iter.key());
+    if (b == baseline.end())
+      continue;
+    const auto& curr = iter.value();
+    if (curr.ns_per_op > b->ns_per_op * (1 + tolerance))
+      regressions.append(QStringLiteral("%1: %2 ns/op, baseline %3 ns/op")
+                         .arg(iter.key()).arg(curr.ns_per_op, 0, 'f', 1).arg(b->ns_per_op, 0, 'f', 1));
+    // allocations count is stable, any growth is a regression
+    if (curr.allocs_per_op > b->allocs_per_op + 0.5)
+      regressions.append(QStringLiteral("%1: %2 allocs/op, baseline %3 allocs/op")
+                         .arg(iter.key()).arg(curr.allocs_per_op, 0, 'f', 2).arg(b->allocs_per_op, 0, 'f', 2));
+  }
+
+  for (const auto& r : std::as_const(regressions))
+    qWarning("regression: %s", qUtf8Printable(r));
+  QVERIFY2(regressions.isEmpty(), "performance regressions detected");
+}
+
+void RenderBenchmark::formatDateTime_data()
+{
+  QTest::addColumn<QString>("format");
+
+  QTest::newRow("hh:mm a") << u"hh:mm a"_s;
+  QTest::newRow("HH:mm:ss") << u"HH:mm:ss"_s;
+  QTest::newRow("long date") << u"dddd, d MMMM yyyy\\nHH:mm:ss"_s;
+}
+
+void RenderBenchmark::formatDateTime()
+{
+  QFETCH(QString, format);
+
+  DateTimeStringBuilder null_builder;
+  CompiledDateTimeFormat cfmt(format);
+
+  run([&]() { FormatDateTime(_dt, cfmt, null_builder); }, 100000);
+}
+
+void RenderBenchmark::skinProcess_data()
+{
+  QTest::addColumn<QString>("skin");
+
+  QTest::newRow("font") << u"font"_s;
+  QTest::newRow("legacy") << u"legacy"_s;
+  QTest::newRow("modern") << u"modern"_s;
+}
+
+void RenderBenchmark::skinProcess()
+{
+  QFETCH(QString, skin);
+
+  auto s = createSkin(skin);
+  if (!s)
+    QSKIP("skin is not available");
+  s->setSeparatorAnimationEnabled(false);
+
+  // every call is the next tick
+  auto dt = _dt;
+  run([&]() { s->process(dt); dt = dt.addSecs(1); });
+}
+
+void RenderBenchmark::skinRebuild_data()
+{
+  QTest::addColumn<QString>("skin");
+
+  QTest::newRow("font") << u"font"_s;
+  QTest::newRow("legacy") << u"legacy"_s;
+}
+
+// glyphs count is changed every tick (9:59:59 -> 10:00:00 and back),
+// so the whole frame is rebuilt each time, shows per-frame allocations
+void RenderBenchmark::skinRebuild()
+{
+  QFETCH(QString, skin);
+
+  auto s = std::dynamic_pointer_cast<ClassicSkin>(createSkin(skin));
+  if (!s)
+    QSKIP("skin is not available");
+  s->setSeparatorAnimationEnabled(false);
+  s->setFormat(u"h:mm:ss"_s);
+
+  const QDateTime dts[] = {
+    QDateTime(_dt.date(), QTime(9, 59, 59)),
+    QDateTime(_dt.date(), QTime(10, 0, 0)),
+  };
+  int i = 0;
+  // previous frame is kept until the next one is ready, as window does
+  std::shared_ptr<Resource> res;
+  run([&]() { auto prev = std::exchange(res, s->process(dts[i++ % 2])); });
+}
+
+void RenderBenchmark::linearLayout_data()
+{
+  QTest::addColumn<int>("count");
+
+  QTest::newRow("10") << 10;
+  QTest::newRow("100") << 100;
+  QTest::newRow("1000") << 1000;
+}
+
+void RenderBenchmark::linearLayout()
+{
+  QFETCH(int, count);
+
+  auto layout = std::make_shared<LinearLayout>(Qt::Horizontal);
+  for (int i = 0; i < count; i++)
+    layout->addItem(std::make_shared<LayoutItem>(
+        std::make_shared<InvisibleResource>(QRectF(0, -8, 6, 10), 6, 10)));
+
+  // invalidating the layout itself forces doBuildLayout() over all items
+  run([&]() { layout->invalidateGeometry(); layout->updateGeometry(); }, 10000 / count + 10);
+}
+
+void RenderBenchmark::multiLineLayout_data()
+{
+  QTest::addColumn<Qt::Orientation>("orientation");
+  QTest::addColumn<int>("lines");
+  QTest::addColumn<int>("glyphs");
+
+  // typical date/time layouts: lines of glyphs inside the layout of opposite direction
+  QTest::newRow("time") << Qt::Horizontal << 1 << 8;
+  QTest::newRow("time+date") << Qt::Horizontal << 2 << 10;
+  QTest::newRow("long date") << Qt::Horizontal << 3 << 24;
+  QTest::newRow("vertical") << Qt::Vertical << 2 << 8;
+}
+
+void RenderBenchmark::multiLineLayout()
+{
+  QFETCH(Qt::Orientation, orientation);
+  QFETCH(int, lines);
+  QFETCH(int, glyphs);
+
+  const auto opposite = orientation == Qt::Horizontal ? Qt::Vertical : Qt::Horizontal;
+  auto layout = std::make_shared<LinearLayout>(opposite);
+  std::vector<std::shared_ptr<LinearLayout>> line_layouts;
+  for (int l = 0; l < lines; l++) {
+    auto line = std::make_shared<LinearLayout>(orientation);
+    for (int i = 0; i < glyphs; i++) {
+      // separator-like glyph in the middle of the line
+      const bool narrow = i % 3 == 2;
+      line->addItem(std::make_shared<LayoutItem>(
+          std::make_shared<InvisibleResource>(QRectF(0, -8, narrow ? 2 : 6, 10), narrow ? 2 : 6, 10)));
+      line->setItemAlignment(i, narrow ? Qt::AlignCenter : Qt::AlignBaseline | Qt::AlignJustify);
+    }
+    layout->addItem(line);
+    line_layouts.push_back(std::move(line));
+  }
+
+  // every line is rebuilt, as it happens when all glyphs change
+  run([&]() {
+    for (const auto& line : line_layouts) line->invalidateGeometry();
+    layout->updateGeometry();
+  });
+}
+
+void RenderBenchmark::cachedResource_data()
+{
+  QTest::addColumn<bool>("hot");
+
+  QTest::newRow("hot") << true;
+  QTest::newRow("cold") << false;
+}
+
+void RenderBenchmark::cachedResource()
+{
+  QFETCH(bool, hot);
+
+  const QFont fnt(u"Sans"_s, 48);
+  auto cache = std::make_shared<GlyphCache>();
+  auto res = std::make_shared<CachedResource>(std::make_shared<FontResource>(fnt, '8'), cache);
+  auto img = makeTarget(res->rect().size().toSize() + QSize(2, 2));
+
+  run([&]() {
+    if (!hot) cache->clear();
+    QPainter p(&img);
+    p.translate(-res->rect().topLeft());
+    res->draw(&p);
+  });
+}
+
+void RenderBenchmark::effectsStack_data()
+{
+  QTest::addColumn<QBrush>("texture");
+  QTest::addColumn<QBrush>("background");
+  QTest::addColumn<bool>("stretch");
+
+  QLinearGradient gradient(0, 0, 0, 1);
+  gradient.setCoordinateMode(QGradient::ObjectBoundingMode);
+  gradient.setColorAt(0, Qt::red);
+  gradient.setColorAt(1, Qt::blue);
+
+  QTest::newRow("background") << QBrush() << QBrush(Qt::yellow) << false;
+  QTest::newRow("color") << QBrush(Qt::magenta) << QBrush() << false;
+  QTest::newRow("gradient") << QBrush(gradient) << QBrush() << false;
+  QTest::newRow("gradient+background") << QBrush(gradient) << QBrush(Qt::yellow) << true;
+}
+
+void RenderBenchmark::effectsStack()
+{
+  QFETCH(QBrush, texture);
+  QFETCH(QBrush, background);
+  QFETCH(bool, stretch);
+
+  // exactly the stack classic skins build, without arena and caching
+  auto res = buildEffectsStack(nullptr, std::make_shared<FontResource>(QFont(u"Sans"_s, 48), '8'),
+                               {texture, stretch}, {background, stretch});
+
+  auto img = makeTarget(res->rect().size().toSize() + QSize(2, 2));
+  run([&]() { drawFrame(img, *res); });
+}
+
+void RenderBenchmark::offscreenFrame_data()
+{
+  QTest::addColumn<qreal>("dpr");
+
+  QTest::newRow("1x") << 1.0;
+  QTest::newRow("2x") << 2.0;
+  QTest::newRow("4x") << 4.0;
+}
+
+void RenderBenchmark::offscreenFrame()
+{
+  QFETCH(qreal, dpr);
+
+  // what clock widget does on each tick
+  auto skin = createSkin(u"font"_s);
+  skin->setSeparatorAnimationEnabled(false);
+  auto res = skin->process(_dt);
+  auto img = makeTarget(res->rect().size().toSize() + QSize(2, 2), dpr);
+
+  // both LayoutItem-based and flat layouts are counted
+  LayoutItem::resetRecalculatedItemsCount();
+  res = skin->process(_dt.addSecs(1));
+  qInfo("layout nodes recalculated per frame: %zu", LayoutItem::recalculatedItemsCount());
+
+  auto dt = _dt;
+  run([&]() {
+    auto r = skin->process(dt);
+    drawFrame(img, *r);
+    dt = dt.addSecs(1);
+  }, 200);
+}
+
+QHash<QString, Measurement> RenderBenchmark::loadResults(const QString& filename)
+{
+  QHash<QString, Measurement> results;
+  QFile f(filename);
+  if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    qWarning("can't open baseline file: %s", qUtf8Printable(filename));
+    return results;
+  }
+  while (!f.atEnd()) {
+    const auto parts = QString::fromUtf8(f.readLine()).trimmed().split(u',');
+    if (parts.size() != 3) continue;
+    results[parts[0]] = {parts[1].toDouble(), parts[2].toDouble()};
+  }
+  return results;
+}
+
+void RenderBenchmark::saveResults(const QString& filename, const QHash<QString, Measurement>& results)
+{
+  QFile f(filename);
+  if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    qWarning("can't write results file: %s", qUtf8Printable(filename));
+    return;
+  }
+  for (auto iter = results.cbegin(); iter != results.cend(); ++iter)
+    f.write(QStringLiteral("%1,%2,%3\n").arg(iter.key())
+            .arg(iter->ns_per_op, 0, 'f', 1).arg(iter->allocs_per_op, 0, 'f', 2).toUtf8());
+}
+
+QTEST_MAIN(RenderBenchmark)
+
+#include "bench_render.moc"
@@ -0,0 +1,119 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <QTest>
+
+#include "classic_skin.hpp"
+
+namespace {
+
+// all glyphs have the same size, like in monospace font
+class FakeResourceFactory final : public ResourceFactory
+{
+public:
+  qreal ascent() const override { return 8; }
+  qreal descent() const override { return 2; }
+
+protected:
+  std::shared_ptr<Resource> create(char32_t ch) const override
+  {
+    Q_UNUSED(ch)
+    return std::make_shared<InvisibleResource>(QRectF(0, -8, 6, 10), 6, 10);
+  }
+};
+
+} // namespace
+
+class ClassicSkinTest : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void init();
+  void cleanup();
+
+  void fullUpdateOnRebuild();
+  void nothingChanged();
+  void onlyChangedGlyphs();
+  void separatorAnimation();
+
+private:
+  std::unique_ptr<ClassicSkin> _skin;
+  QDateTime _dt;
+};
+
+void ClassicSkinTest::init()
+{
+  _skin = std::make_unique<ClassicSkin>(std::make_shared<FakeResourceFactory>());
+  _skin->setFormat(QLatin1String("HH:mm:ss"));
+  _skin->setSeparatorAnimationEnabled(false);
+  _dt = QDateTime(QDate(2024, 3, 1), QTime(12, 30, 56));
+}
+
+void ClassicSkinTest::cleanup()
+{
+  _skin.reset();
+}
+
+void ClassicSkinTest::fullUpdateOnRebuild()
+{
+  // no previous frame - everything is changed
+  _skin->process(_dt);
+  QVERIFY(!_skin->changedRect());
+
+  // same after configuration change
+  _skin->setFormat(QLatin1String("HH:mm"));
+  _skin->process(_dt);
+  QVERIFY(!_skin->changedRect());
+}
+
+void ClassicSkinTest::nothingChanged()
+{
+  _skin->process(_dt);
+  _skin->process(_dt.addMSecs(300));
+  QVERIFY(_skin->changedRect());
+  QVERIFY(_skin->changedRect()->isEmpty());
+}
+
+void ClassicSkinTest::onlyChangedGlyphs()
+{
+  auto res = _skin->process(_dt);
+  const auto full_rect = res->rect();
+
+  // only the last digit is changed
+  res = _skin->process(_dt.addSecs(1));
+  QCOMPARE(res->rect(), full_rect);
+  auto r = _skin->changedRect();
+  QVERIFY(r);
+  QCOMPARE(r->width(), 6);
+  QCOMPARE(r->right(), full_rect.right());
+
+  // both seconds digits are changed
+  _skin->process(_dt.addSecs(-6));
+  r = _skin->changedRect();
+  QVERIFY(r);
+  QCOMPARE(r->width(), 12);
+  QCOMPARE(r->right(), full_rect.right());
+}
+
+void ClassicSkinTest::separatorAnimation()
+{
+  _skin->setSeparatorAnimationEnabled(true);
+  auto res = _skin->process(_dt);
+  const auto full_rect = res->rect();
+
+  // both separators are hidden, area between them is changed
+  _skin->animateSeparator();
+  _skin->process(_dt);
+  auto r = _skin->changedRect();
+  QVERIFY(r);
+  QVERIFY(!r->isEmpty());
+  QVERIFY(r->width() < full_rect.width());
+}
+
+QTEST_MAIN(ClassicSkinTest)
+
+#include "test_classic_skin.moc"
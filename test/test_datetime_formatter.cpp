@@ -8,6 +8,8 @@
 
 #include "datetime_formatter.hpp"
 
+using namespace Qt::Literals::StringLiterals;
+
 namespace {
 
 class SimpleDateTimeStringBuilder final : public DateTimeStringBuilder
@@ -22,22 +24,26 @@ public:
 
   void tokenStart(QStringView token) override { _tokens[token.toString()] += 1; }
   void tokenEnd(QStringView token)   override { _tokens[token.toString()] -= 1; }
+  void tokenUnchanged(QStringView token) override { _unchanged.append(token.toString()); }
 
   QString result() const { return QString::fromUcs4(_result.data(), _result.size()); }
   QString separators() const { return QString::fromUcs4(_seps.data(), _seps.size()); }
   const auto& tokens() const noexcept { return _tokens; }
+  const auto& unchanged() const noexcept { return _unchanged; }
 
   void reset()
   {
     _result.clear();
     _seps.clear();
     _tokens.clear();
+    _unchanged.clear();
   }
 
 private:
   QVector<char32_t> _result;
   QVector<char32_t> _seps;
   QHash<QString, int> _tokens;
+  QStringList _unchanged;
 };
 
 } // namespace
@@ -59,6 +65,12 @@ private slots:
   void testComplexCase();
   void testUnicode();
   void testTokenNotify();
+  void testCompiledFormat_data();
+  void testCompiledFormat();
+  void testUnchangedTokens();
+  void testUpdateInterval();
+  void benchmarkFormat_data();
+  void benchmarkFormat();
 
 private:
   SimpleDateTimeStringBuilder sb;
@@ -200,6 +212,114 @@ void DateTimeFormatterTest::testTokenNotify()
   QCOMPARE(sb.tokens()["ss"], 0);
 }
 
+void DateTimeFormatterTest::testCompiledFormat_data()
+{
+  QTest::addColumn<QString>("format");
+
+  QTest::newRow("default") << u"hh:mm a"_s;
+  QTest::newRow("24h") << u"HH:mm:ss"_s;
+  QTest::newRow("no padding") << u"H:m:s"_s;
+  QTest::newRow("12h") << u"h:mm AP"_s;
+  QTest::newRow("am/pm") << u"hh:mm ap Ap aP A"_s;
+  QTest::newRow("date") << u"d.M.yy dd.MM.yyyy"_s;
+  QTest::newRow("names") << u"ddd dddd MMM MMMM"_s;
+  QTest::newRow("custom") << u"W WW J"_s;
+  QTest::newRow("complex") << u"hh:mm:x'\\n'x:ss:W,J,yyyy\\nx"_s;
+  QTest::newRow("unicode") << u"\U0001F605hh\U0001F643\U0001F643mm\U0001FAE0"_s;
+  QTest::newRow("odd repeats") << u"hhh:mmm:sss yyy z zzz"_s;
+  QTest::newRow("separators") << u"hh::mm':'ss\\:zz"_s;
+}
+
+void DateTimeFormatterTest::testCompiledFormat()
+{
+  // compiled format should produce exactly the same output
+  QFETCH(QString, format);
+
+  CompiledDateTimeFormat cfmt(format);
+  SimpleDateTimeStringBuilder csb;
+
+  const QDateTime dts[] = {
+    dt,
+    QDateTime(QDate(2024, 2, 29), QTime(12, 0, 5, 7)),
+    QDateTime(QDate(2024, 7, 7), QTime(23, 59, 59, 999)),
+    QDateTime(QDate(1999, 1, 1), QTime(9, 5, 0)),
+  };
+
+  for (const auto& t : dts) {
+    FormatDateTime(t, format, sb);
+    FormatDateTime(t, cfmt, csb);
+    QCOMPARE(csb.result(), sb.result());
+    QCOMPARE(csb.separators(), sb.separators());
+    QCOMPARE(csb.tokens(), sb.tokens());
+    sb.reset();
+    csb.reset();
+  }
+}
+
+void DateTimeFormatterTest::testUnchangedTokens()
+{
+  CompiledDateTimeFormat cfmt(u"'x'HH:mm:ss ddd"_s);
+
+  // only seconds are changed, everything else is reported as is
+  cfmt.format(dt, dt.addSecs(-1), sb);
+  QCOMPARE(sb.result(), u"x::56 ");
+  QCOMPARE(sb.separators(), u"::");
+  QCOMPARE(sb.unchanged(), QStringList({u"HH"_s, u"mm"_s, u"ddd"_s}));
+  QCOMPARE(sb.tokens().size(), 1);
+  QVERIFY(sb.tokens().contains(u"ss"_s));
+  sb.reset();
+
+  // an hour back crosses midnight, so hours and day are changed
+  cfmt.format(dt, dt.addSecs(-3600), sb);
+  QCOMPARE(sb.unchanged(), QStringList({u"mm"_s, u"ss"_s}));
+  sb.reset();
+
+  // invalid previous value means "format everything"
+  cfmt.format(dt, QDateTime(), sb);
+  QVERIFY(sb.unchanged().isEmpty());
+  QCOMPARE(sb.tokens().size(), 4);
+}
+
+void DateTimeFormatterTest::testUpdateInterval()
+{
+  using namespace std::chrono_literals;
+  QCOMPARE(CompiledDateTimeFormat(u"hh:mm a"_s).updateInterval(), 1min);
+  QCOMPARE(CompiledDateTimeFormat(u"dddd, d MMMM yyyy"_s).updateInterval(), 1min);
+  QCOMPARE(CompiledDateTimeFormat(u"HH:mm:ss"_s).updateInterval(), 1s);
+  QCOMPARE(CompiledDateTimeFormat(u"'ss'HH:mm"_s).updateInterval(), 1min);
+}
+
+void DateTimeFormatterTest::benchmarkFormat_data()
+{
+  QTest::addColumn<QString>("format");
+  QTest::addColumn<bool>("compiled");
+
+  const QString formats[] = {u"hh:mm a"_s, u"HH:mm:ss"_s, u"dddd, d MMMM yyyy\\nHH:mm:ss"_s};
+  for (const auto& f : formats) {
+    QTest::addRow("parse: %ls", qUtf16Printable(f)) << f << false;
+    QTest::addRow("compiled: %ls", qUtf16Printable(f)) << f << true;
+  }
+}
+
+void DateTimeFormatterTest::benchmarkFormat()
+{
+  QFETCH(QString, format);
+  QFETCH(bool, compiled);
+
+  DateTimeStringBuilder null_builder;
+  CompiledDateTimeFormat cfmt(format);
+
+  if (compiled) {
+    QBENCHMARK {
+      FormatDateTime(dt, cfmt, null_builder);
+    }
+  } else {
+    QBENCHMARK {
+      FormatDateTime(dt, format, null_builder);
+    }
+  }
+}
+
 QTEST_MAIN(DateTimeFormatterTest)
 
 #include "test_datetime_formatter.moc"
@@ -0,0 +1,182 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <QTest>
+
+#include <QImage>
+
+#include <functional>
+
+#include "display_list.hpp"
+#include "flat_layout.hpp"
+#include "linear_layout.hpp"
+
+namespace {
+
+// filled rect, cache key is its color
+class FillResource final : public Resource
+{
+public:
+  FillResource(QRectF r, QColor c) noexcept : _rect(std::move(r)), _color(std::move(c)) {}
+
+  QRectF rect() const noexcept override { return _rect; }
+  qreal advanceX() const noexcept override { return _rect.width(); }
+  qreal advanceY() const noexcept override { return _rect.height(); }
+
+  void draw(QPainter* p) override { p->fillRect(_rect, _color); }
+
+  size_t cacheKey() const noexcept override { return _color.rgba(); }
+
+private:
+  QRectF _rect;
+  QColor _color;
+};
+
+auto createResource(QColor c)
+{
+  return std::make_shared<FillResource>(QRectF(0, -4, 4, 5), std::move(c));
+}
+
+// two lines of colored rects
+std::shared_ptr<FlatLayout> createFlatLayout(std::vector<FlatLayout::NodeId>& items)
+{
+  auto l = std::make_shared<FlatLayout>();
+  const auto root = l->addLayout(FlatLayout::no_node, Qt::Vertical, 1);
+  const auto line1 = l->addLayout(root, Qt::Horizontal, 2);
+  items.push_back(l->addItem(line1, createResource(Qt::red)));
+  items.push_back(l->addItem(line1, createResource(Qt::green)));
+  const auto line2 = l->addLayout(root, Qt::Horizontal);
+  items.push_back(l->addItem(line2, createResource(Qt::blue), QTransform::fromScale(2, 1)));
+  l->updateGeometry();
+  return l;
+}
+
+QImage render(const std::function<void(QPainter*)>& draw)
+{
+  QImage img(32, 32, QImage::Format_ARGB32_Premultiplied);
+  img.fill(Qt::transparent);
+  QPainter p(&img);
+  p.translate(8, 8);
+  draw(&p);
+  return img;
+}
+
+} // namespace
+
+class DisplayListTest : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void empty();
+  void flattenLinearLayout();
+  void flattenFlatLayout();
+  void recordedFrom();
+  void diff();
+  void replay();
+};
+
+void DisplayListTest::empty()
+{
+  const auto list = DisplayList::record(nullptr);
+  QVERIFY(list.isEmpty());
+  QVERIFY(list.diff(DisplayList()).isEmpty());
+}
+
+void DisplayListTest::flattenLinearLayout()
+{
+  auto inner = std::make_shared<LinearLayout>(Qt::Horizontal);
+  auto outer = std::make_shared<LinearLayout>(Qt::Vertical);
+  outer->addItem(std::make_shared<LayoutItem>(createResource(Qt::red)));
+  outer->addItem(inner);
+  inner->addItem(std::make_shared<LayoutItem>(createResource(Qt::green)));
+  inner->addItem(std::make_shared<LayoutItem>(createResource(Qt::blue)));
+  outer->updateGeometry();
+
+  const auto list = DisplayList::record(outer->resource());
+  const auto& cmds = list.commands();
+  QCOMPARE(cmds.size(), std::size_t(3));
+
+  // only leaves are recorded, in drawing order
+  QCOMPARE(cmds[0].res, outer->items()[0]->resource());
+  QCOMPARE(cmds[1].res, inner->items()[0]->resource());
+  QCOMPARE(cmds[2].res, inner->items()[1]->resource());
+
+  const auto inner_pos = inner->pos();
+  QCOMPARE(cmds[0].bounds, outer->items()[0]->rect().translated(outer->items()[0]->pos()));
+  QCOMPARE(cmds[1].bounds, inner->items()[0]->rect().translated(inner->items()[0]->pos() + inner_pos));
+  QCOMPARE(cmds[2].bounds, inner->items()[1]->rect().translated(inner->items()[1]->pos() + inner_pos));
+}
+
+void DisplayListTest::flattenFlatLayout()
+{
+  std::vector<FlatLayout::NodeId> items;
+  auto l = createFlatLayout(items);
+
+  const auto list = DisplayList::record(l);
+  const auto& cmds = list.commands();
+  QCOMPARE(cmds.size(), items.size());
+  for (std::size_t i = 0; i < items.size(); i++) {
+    QCOMPARE(cmds[i].transform, l->rootTransform(items[i]));
+    QCOMPARE(cmds[i].bounds, l->geometryInRoot(items[i]));
+  }
+}
+
+void DisplayListTest::recordedFrom()
+{
+  std::vector<FlatLayout::NodeId> items;
+  auto l = createFlatLayout(items);
+  auto list = DisplayList::record(l);
+  QVERIFY(list.isRecordedFrom(l));
+  QVERIFY(!list.isRecordedFrom(nullptr));
+  QVERIFY(!list.isRecordedFrom(createResource(Qt::red)));
+
+  l->setResource(items[1], createResource(Qt::yellow));
+  QVERIFY(!list.isRecordedFrom(l));
+
+  list = DisplayList::record(l);
+  QVERIFY(list.isRecordedFrom(l));
+}
+
+void DisplayListTest::diff()
+{
+  std::vector<FlatLayout::NodeId> items;
+  auto l = createFlatLayout(items);
+  const auto list1 = DisplayList::record(l);
+  QVERIFY(list1.diff(DisplayList::record(l)).isEmpty());
+
+  // the same geometry, only the changed item is reported
+  QVERIFY(!l->setResource(items[1], createResource(Qt::yellow)));
+  const auto list2 = DisplayList::record(l);
+  QCOMPARE(list1.diff(list2), l->geometryInRoot(items[1]));
+  QCOMPARE(list2.diff(list1), l->geometryInRoot(items[1]));
+
+  // missing commands are reported too
+  QRectF all;
+  for (auto id : items) all |= l->geometryInRoot(id);
+  QCOMPARE(list1.diff(DisplayList()), all);
+}
+
+void DisplayListTest::replay()
+{
+  std::vector<FlatLayout::NodeId> items;
+  auto l = createFlatLayout(items);
+  const auto list = DisplayList::record(l);
+
+  const auto expected = render([&](QPainter* p) { l->draw(p); });
+  const auto actual = render([&](QPainter* p) {
+    p->setCompositionMode(QPainter::CompositionMode_Source);
+    const auto t = p->transform();
+    list.replay(p);
+    // painter's state is restored
+    QCOMPARE(p->transform(), t);
+    QCOMPARE(p->compositionMode(), QPainter::CompositionMode_Source);
+  });
+  QCOMPARE(actual, expected);
+}
+
+QTEST_MAIN(DisplayListTest)
+#include "test_display_list.moc"
@@ -0,0 +1,78 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <QTest>
+
+#include <QImage>
+#include <QPainter>
+
+#include "effects.hpp"
+
+class EffectsTest : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void compositeNotCacheable();
+  void compositeRepeated();
+  void compositeAlternating();
+};
+
+namespace {
+
+// draws using given layer, returns true if content was rendered
+bool drawComposite(CompositeLayer& layer, size_t key)
+{
+  QImage img(16, 16, QImage::Format_ARGB32_Premultiplied);
+  img.fill(Qt::transparent);
+  QPainter p(&img);
+  bool rendered = false;
+  layer.draw(&p, QRectF(0, 0, 8, 8), key, [&](QPainter* pp) {
+    pp->fillRect(QRectF(0, 0, 8, 8), Qt::red);
+    rendered = true;
+  });
+  return rendered;
+}
+
+} // namespace
+
+void EffectsTest::compositeNotCacheable()
+{
+  CompositeLayer layer;
+  QVERIFY(drawComposite(layer, size_t(-1)));
+  QVERIFY(drawComposite(layer, size_t(-1)));
+  QVERIFY(drawComposite(layer, size_t(-1)));
+}
+
+void EffectsTest::compositeRepeated()
+{
+  CompositeLayer layer;
+  // drawn directly, then cached
+  QVERIFY(drawComposite(layer, 1));
+  QVERIFY(drawComposite(layer, 1));
+  QVERIFY(!drawComposite(layer, 1));
+
+  layer.reset();
+  QVERIFY(drawComposite(layer, 1));
+}
+
+void EffectsTest::compositeAlternating()
+{
+  CompositeLayer layer;
+  // e.g. blinking separator
+  for (size_t key : {1, 2, 1, 2})
+    QVERIFY(drawComposite(layer, key));
+  for (size_t key : {1, 2, 1, 2})
+    QVERIFY(!drawComposite(layer, key));
+
+  // new content replaces the least recently drawn one
+  QVERIFY(drawComposite(layer, 3));
+  QVERIFY(!drawComposite(layer, 2));
+  QVERIFY(drawComposite(layer, 1));
+}
+
+QTEST_MAIN(EffectsTest)
+#include "test_effects.moc"
@@ -0,0 +1,236 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <QTest>
+
+#include <algorithm>
+
+#include "flat_layout.hpp"
+#include "layout.hpp"
+#include "linear_layout.hpp"
+
+namespace {
+
+auto createResource(QRectF r, qreal ax, qreal ay)
+{
+  return std::make_shared<InvisibleResource>(std::move(r), ax, ay);
+}
+
+// resource with changeable cache key
+class KeyResource final : public Resource
+{
+public:
+  explicit KeyResource(size_t key) noexcept : _key(key) {}
+
+  QRectF rect() const noexcept override { return QRectF(0, -4, 4, 4); }
+  qreal advanceX() const noexcept override { return 4; }
+  qreal advanceY() const noexcept override { return 4; }
+
+  void draw(QPainter* p) override { Q_UNUSED(p); }
+
+  size_t cacheKey() const noexcept override { return _key; }
+
+private:
+  size_t _key;
+};
+
+} // namespace
+
+class FlatLayoutTest : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void horizontal();
+  void lineMetrics();
+  void childrenOrder();
+  void sameAsLinearLayout_data();
+  void sameAsLinearLayout();
+  void replaceResource();
+};
+
+// the same as LinearLayoutTest::horizontal()
+void FlatLayoutTest::horizontal()
+{
+  FlatLayout l;
+  const auto root = l.addLayout(FlatLayout::no_node, Qt::Horizontal);
+  const FlatLayout::NodeId items[] = {
+    l.addItem(root, createResource(QRectF( 0, -4, 5, 6), 5, 5)),
+    l.addItem(root, createResource(QRectF(-1, -3, 4, 7), 5, 4)),
+    l.addItem(root, createResource(QRectF(-1, -5, 4, 6), 3, 8)),
+    l.addItem(root, createResource(QRectF(-2, -2, 5, 5), 5, 4)),
+  };
+  QVERIFY(l.isGeometryDirty());
+  l.updateGeometry();
+  QVERIFY(!l.isGeometryDirty());
+
+  QCOMPARE(l.rect(), QRectF(0, -5, 16, 9));
+  QCOMPARE(l.advanceX(), 18);
+  QCOMPARE(l.advanceY(), 8);
+
+  QCOMPARE(l.geometryInRoot(items[0]), QRectF( 0, -4, 5, 6));
+  QCOMPARE(l.geometryInRoot(items[1]), QRectF( 4, -3, 4, 7));
+  QCOMPARE(l.geometryInRoot(items[2]), QRectF( 9, -5, 4, 6));
+  QCOMPARE(l.geometryInRoot(items[3]), QRectF(11, -2, 5, 5));
+}
+
+void FlatLayoutTest::lineMetrics()
+{
+  FlatLayout l;
+  const auto root = l.addLayout(FlatLayout::no_node, Qt::Horizontal);
+  l.addItem(root, createResource(QRectF(0, -4, 5, 6), 5, 5));
+  l.setLineMetrics(root, 8, 3);
+  l.updateGeometry();
+
+  // only height is affected
+  QCOMPARE(l.rect(), QRectF(0, -8, 5, 11));
+  QCOMPARE(l.advanceX(), 5);
+  QCOMPARE(l.advanceY(), 5);
+}
+
+void FlatLayoutTest::childrenOrder()
+{
+  FlatLayout l;
+  const auto root = l.addLayout(FlatLayout::no_node, Qt::Vertical);
+  const auto line1 = l.addLayout(root, Qt::Horizontal);
+  const auto a = l.addItem(line1, createResource(QRectF(0, -4, 5, 6), 5, 5));
+  const auto line2 = l.addLayout(root, Qt::Horizontal);
+  const auto b = l.addItem(line2, createResource(QRectF(0, -4, 5, 6), 5, 5));
+  const auto c = l.addItem(line2, createResource(QRectF(0, -4, 5, 6), 5, 5));
+  l.updateGeometry();
+
+  QCOMPARE(l.size(), 6u);
+  QCOMPARE(l.parent(b), line2);
+  QVERIFY(std::ranges::equal(l.children(root), std::vector{line1, line2}));
+  QVERIFY(std::ranges::equal(l.children(line1), std::vector{a}));
+  QVERIFY(std::ranges::equal(l.children(line2), std::vector{b, c}));
+  QVERIFY(l.children(c).empty());
+}
+
+void FlatLayoutTest::sameAsLinearLayout_data()
+{
+  QTest::addColumn<Qt::Orientation>("orientation");
+  QTest::addColumn<qreal>("spacing");
+  QTest::addColumn<bool>("ignore_advance");
+  QTest::addColumn<QString>("config");
+
+  QTest::newRow("horizontal") << Qt::Horizontal << 0.0 << false << QString();
+  QTest::newRow("vertical") << Qt::Vertical << 0.0 << false << QString();
+  QTest::newRow("spacing") << Qt::Horizontal << 2.0 << false << QString();
+  QTest::newRow("ignore advance") << Qt::Vertical << 1.0 << true << QString();
+  QTest::newRow("alignment") << Qt::Horizontal << 0.0 << false << QStringLiteral("<x>");
+  QTest::newRow("resize") << Qt::Horizontal << 0.0 << false << QStringLiteral("1>0");
+  QTest::newRow("resize vertical") << Qt::Vertical << 0.0 << false << QStringLiteral("01<");
+}
+
+// lines of items inside the layout of opposite direction,
+// results must be exactly the same as for LinearLayout
+void FlatLayoutTest::sameAsLinearLayout()
+{
+  QFETCH(Qt::Orientation, orientation);
+  QFETCH(qreal, spacing);
+  QFETCH(bool, ignore_advance);
+  QFETCH(QString, config);
+
+  const QList<QList<std::tuple<QRectF, qreal, qreal>>> lines = {
+    {{QRectF(0, -4, 5, 6), 5, 5}, {QRectF(-1, -3, 4, 7), 5, 4}},
+    {{QRectF(-1, -5, 15, 6), 18, 9}, {QRectF(-1, -7, 20, 8), 18, 9}, {QRectF(-2, -2, 5, 5), 5, 4}},
+    {{QRectF(-1, -5, 10, 6), 10, 9}},
+  };
+  const auto opposite = orientation == Qt::Horizontal ? Qt::Vertical : Qt::Horizontal;
+  const QTransform t = QTransform::fromScale(1.5, 1.5);
+
+  auto applyConfig = [&](auto&& resize, auto&& align) {
+    for (qsizetype i = 0; i < config.size(); i++) {
+      if (config[i] == u'1') resize(i);
+      if (config[i] == u'<') align(i, Qt::AlignLeft | Qt::AlignTop);
+      if (config[i] == u'>') align(i, Qt::AlignRight | Qt::AlignBottom);
+      if (config[i] == u'x') align(i, Qt::AlignCenter);
+    }
+  };
+
+  auto ref = std::make_shared<LinearLayout>(opposite, spacing);
+  ref->setIgnoreAdvance(ignore_advance);
+  std::vector<std::shared_ptr<LayoutItem>> ref_items;
+  for (const auto& line : lines) {
+    auto ll = std::make_shared<LinearLayout>(orientation, spacing);
+    ll->setIgnoreAdvance(ignore_advance);
+    for (const auto& [r, ax, ay] : line) {
+      auto item = std::make_shared<LayoutItem>(createResource(r, ax, ay));
+      item->setTransform(t);
+      ll->addItem(item);
+      ref_items.push_back(std::move(item));
+    }
+    ref->addItem(std::move(ll));
+  }
+  applyConfig([&](auto i) { ref->items()[i]->enableResize(); },
+              [&](auto i, auto a) { ref->setItemAlignment(i, a); });
+  ref->updateGeometry();
+
+  FlatLayout l;
+  const auto root = l.addLayout(FlatLayout::no_node, opposite, spacing, ignore_advance);
+  std::vector<FlatLayout::NodeId> line_ids;
+  std::vector<FlatLayout::NodeId> item_ids;
+  for (const auto& line : lines) {
+    const auto id = l.addLayout(root, orientation, spacing, ignore_advance);
+    for (const auto& [r, ax, ay] : line)
+      item_ids.push_back(l.addItem(id, createResource(r, ax, ay), t));
+    line_ids.push_back(id);
+  }
+  applyConfig([&](auto i) { l.setResizeEnabled(line_ids[i], true); },
+              [&](auto i, auto a) { l.setAlignment(line_ids[i], a); });
+  l.updateGeometry();
+
+  const auto& ref_res = ref->resource();
+  QCOMPARE(l.rect(), ref_res->rect());
+  QCOMPARE(l.advanceX(), ref_res->advanceX());
+  QCOMPARE(l.advanceY(), ref_res->advanceY());
+
+  for (std::size_t i = 0; i < ref_items.size(); i++) {
+    const auto& item = *ref_items[i];
+    const auto& line = *item.parent();
+    const auto expected = line.transform().mapRect(item.rect().translated(item.pos())).translated(line.pos());
+    QCOMPARE(l.geometryInRoot(item_ids[i]), expected);
+  }
+}
+
+void FlatLayoutTest::replaceResource()
+{
+  FlatLayout l;
+  const auto root = l.addLayout(FlatLayout::no_node, Qt::Horizontal);
+  const auto a = l.addItem(root, std::make_shared<KeyResource>(1));
+  const auto b = l.addItem(root, std::make_shared<KeyResource>(2));
+  l.updateGeometry();
+  const auto key = l.cacheKey();
+  const auto rect = l.rect();
+
+  // the same geometry, only content is changed
+  QVERIFY(!l.setResource(b, std::make_shared<KeyResource>(3)));
+  QVERIFY(!l.isGeometryDirty());
+  QVERIFY(l.cacheKey() != key);
+
+  // order matters
+  QVERIFY(!l.setResource(a, std::make_shared<KeyResource>(2)));
+  QVERIFY(!l.setResource(b, std::make_shared<KeyResource>(1)));
+  QVERIFY(l.cacheKey() != key);
+  QVERIFY(!l.setResource(a, std::make_shared<KeyResource>(1)));
+  QVERIFY(!l.setResource(b, std::make_shared<KeyResource>(2)));
+  QCOMPARE(l.cacheKey(), key);
+
+  // geometry is changed, the whole tree is recalculated
+  LayoutItem::resetRecalculatedItemsCount();
+  l.updateGeometry();
+  QCOMPARE(LayoutItem::recalculatedItemsCount(), 0);
+  QVERIFY(l.setResource(b, createResource(QRectF(0, -4, 8, 6), 8, 6)));
+  QVERIFY(l.isGeometryDirty());
+  l.updateGeometry();
+  QVERIFY(l.rect() != rect);
+  QCOMPARE(LayoutItem::recalculatedItemsCount(), std::size_t(l.size()));
+}
+
+QTEST_MAIN(FlatLayoutTest)
+
+#include "test_flat_layout.moc"
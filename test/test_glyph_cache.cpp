@@ -0,0 +1,200 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <QTest>
+
+#include "glyph_cache.hpp"
+
+namespace {
+
+QImage makeImage(int w, int h)
+{
+  QImage img(w, h, QImage::Format_ARGB32_Premultiplied);
+  img.fill(Qt::transparent);
+  return img;
+}
+
+} // namespace
+
+class GlyphCacheTest : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void findAndInsert();
+  void byteBudget();
+  void lruOrder();
+  void tooBigItem();
+  void clearAll();
+  void atlasStorage();
+  void atlasOverflow();
+  void atlasBudget();
+  void atlasPageEviction();
+};
+
+void GlyphCacheTest::findAndInsert()
+{
+  GlyphCache cache;
+  QImage out;
+
+  const GlyphCacheKey key{42, QSize(10, 20), 1.0};
+  QVERIFY(!cache.find(key, &out));
+  cache.insert(key, makeImage(10, 20));
+  QVERIFY(cache.find(key, &out));
+  QCOMPARE(out.size(), QSize(10, 20));
+
+  // any key part matters
+  QVERIFY(!cache.find({43, QSize(10, 20), 1.0}, &out));
+  QVERIFY(!cache.find({42, QSize(20, 20), 1.0}, &out));
+  QVERIFY(!cache.find({42, QSize(10, 20), 2.0}, &out));
+
+  QCOMPARE(cache.stats().hits, 1u);
+  QCOMPARE(cache.stats().misses, 4u);
+  QCOMPARE(cache.stats().evictions, 0u);
+}
+
+void GlyphCacheTest::byteBudget()
+{
+  const auto item_bytes = qsizetype(10) * 10 * makeImage(10, 10).depth() / 8;
+  GlyphCache cache(3 * item_bytes);
+
+  for (size_t i = 0; i < 5; i++)
+    cache.insert({i, QSize(10, 10), 1.0}, makeImage(10, 10));
+
+  QCOMPARE(cache.count(), 3);
+  QCOMPARE(cache.usedBytes(), 3 * item_bytes);
+  QCOMPARE(cache.stats().evictions, 2u);
+
+  cache.setMaxBytes(item_bytes);
+  QCOMPARE(cache.count(), 1);
+  QCOMPARE(cache.usedBytes(), item_bytes);
+}
+
+void GlyphCacheTest::lruOrder()
+{
+  const auto item_bytes = qsizetype(10) * 10 * makeImage(10, 10).depth() / 8;
+  GlyphCache cache(2 * item_bytes);
+  QImage out;
+
+  cache.insert({1, QSize(10, 10), 1.0}, makeImage(10, 10));
+  cache.insert({2, QSize(10, 10), 1.0}, makeImage(10, 10));
+  // touch the first one, so the second one should be evicted
+  QVERIFY(cache.find({1, QSize(10, 10), 1.0}, &out));
+  cache.insert({3, QSize(10, 10), 1.0}, makeImage(10, 10));
+
+  QVERIFY(cache.find({1, QSize(10, 10), 1.0}, &out));
+  QVERIFY(!cache.find({2, QSize(10, 10), 1.0}, &out));
+  QVERIFY(cache.find({3, QSize(10, 10), 1.0}, &out));
+}
+
+void GlyphCacheTest::tooBigItem()
+{
+  GlyphCache cache(16);
+  QImage out;
+  cache.insert({1, QSize(10, 10), 1.0}, makeImage(10, 10));
+  QVERIFY(!cache.find({1, QSize(10, 10), 1.0}, &out));
+  QCOMPARE(cache.usedBytes(), 0);
+}
+
+void GlyphCacheTest::clearAll()
+{
+  GlyphCache c1;
+  GlyphCache c2;
+  QImage out;
+
+  c1.insert({1, QSize(10, 10), 1.0}, makeImage(10, 10));
+  c2.insert({1, QSize(10, 10), 1.0}, makeImage(10, 10));
+  GlyphCache::clearAll();
+  QVERIFY(!c1.find({1, QSize(10, 10), 1.0}, &out));
+  QVERIFY(!c2.find({1, QSize(10, 10), 1.0}, &out));
+  QCOMPARE(c1.usedBytes(), 0);
+}
+
+void GlyphCacheTest::atlasStorage()
+{
+  GlyphCache cache;
+  cache.setAtlasEnabled(true);
+
+  QImage src = makeImage(10, 20);
+  src.setDevicePixelRatio(2.0);
+  for (size_t i = 0; i < 10; i++)
+    cache.insert({i, QSize(10, 20), 2.0}, src);
+
+  // everything is in the single image
+  QCOMPARE(cache.count(), 10);
+  QCOMPARE(cache.atlas().pagesCount(), 1);
+
+  auto img = cache.get({3, QSize(10, 20), 2.0});
+  QVERIFY(img);
+  QCOMPARE(img.img, &cache.atlas().page(0));
+  QCOMPARE(img.src.size(), QSize(10, 20));
+
+  // parts of atlas are returned as separate images
+  QImage out;
+  QVERIFY(cache.find({5, QSize(10, 20), 2.0}, &out));
+  QCOMPARE(out.size(), QSize(10, 20));
+  QCOMPARE(out.devicePixelRatio(), 2.0);
+}
+
+void GlyphCacheTest::atlasOverflow()
+{
+  // only one page is allowed
+  GlyphCache cache(GlyphAtlas::default_page_size.width() * GlyphAtlas::default_page_size.height() * 4);
+  cache.setAtlasEnabled(true);
+
+  const QSize sz(600, 600);
+  cache.insert({1, sz, 1.0}, makeImage(sz.width(), sz.height()));
+  cache.insert({2, sz, 1.0}, makeImage(sz.width(), sz.height()));
+
+  // no space for the second item, so the page is released
+  QImage out;
+  QVERIFY(!cache.find({1, sz, 1.0}, &out));
+  QVERIFY(cache.find({2, sz, 1.0}, &out));
+  QCOMPARE(cache.atlas().pagesCount(), 1);
+  QCOMPARE(cache.stats().evictions, 1u);
+}
+
+void GlyphCacheTest::atlasBudget()
+{
+  const auto page_bytes = GlyphAtlas().pageBytes();
+  GlyphCache cache(2 * page_bytes);
+  cache.setAtlasEnabled(true);
+
+  // atlas page is counted rather than its items
+  for (size_t i = 0; i < 10; i++)
+    cache.insert({i, QSize(10, 10), 1.0}, makeImage(10, 10));
+  QCOMPARE(cache.usedBytes(), page_bytes);
+
+  // too wide for atlas, stored as is
+  const auto wide = makeImage(1100, 10);
+  cache.insert({100, wide.size(), 1.0}, wide);
+  QCOMPARE(cache.usedBytes(), page_bytes + wide.sizeInBytes());
+  QCOMPARE(cache.stats().evictions, 0u);
+}
+
+void GlyphCacheTest::atlasPageEviction()
+{
+  const auto page_bytes = GlyphAtlas().pageBytes();
+  GlyphCache cache(2 * page_bytes);
+  cache.setAtlasEnabled(true);
+
+  // each item takes the whole page
+  const QSize sz(600, 600);
+  for (size_t i = 1; i <= 3; i++)
+    cache.insert({i, sz, 1.0}, makeImage(sz.width(), sz.height()));
+
+  // only the page of the least recently used item is released
+  QImage out;
+  QVERIFY(!cache.find({1, sz, 1.0}, &out));
+  QVERIFY(cache.find({2, sz, 1.0}, &out));
+  QVERIFY(cache.find({3, sz, 1.0}, &out));
+  QCOMPARE(cache.stats().evictions, 1u);
+  QCOMPARE(cache.usedBytes(), 2 * page_bytes);
+}
+
+QTEST_MAIN(GlyphCacheTest)
+
+#include "test_glyph_cache.moc"
@@ -0,0 +1,92 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <QTest>
+
+#include <QImage>
+#include <QPixmap>
+
+#include "hasher.hpp"
+
+class HasherTest : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void orderSensitive();
+  void colorBrush();
+  void gradientBrush();
+  void textureBrush();
+  void pixmapBrush();
+};
+
+void HasherTest::orderSensitive()
+{
+  QCOMPARE(hasher(1, 2, true), hasher(1, 2, true));
+  QVERIFY(hasher(1, 2) != hasher(2, 1));
+  QVERIFY(hasher(QBrush(Qt::red), false) != hasher(QBrush(Qt::red), true));
+}
+
+void HasherTest::colorBrush()
+{
+  QCOMPARE(hasher(QBrush(Qt::red)), hasher(QBrush(QColor(255, 0, 0))));
+  QVERIFY(hasher(QBrush(Qt::red)) != hasher(QBrush(Qt::blue)));
+  QVERIFY(hasher(QBrush(Qt::red)) != hasher(QBrush(Qt::red, Qt::Dense4Pattern)));
+}
+
+void HasherTest::gradientBrush()
+{
+  QLinearGradient g1(0, 0, 0, 1);
+  g1.setColorAt(0.0, Qt::red);
+  g1.setColorAt(1.0, Qt::blue);
+  QLinearGradient g2 = g1;
+  QCOMPARE(hasher(QBrush(g1)), hasher(QBrush(g2)));
+
+  g2.setColorAt(0.5, Qt::green);
+  QVERIFY(hasher(QBrush(g1)) != hasher(QBrush(g2)));
+
+  QLinearGradient g3(0, 0, 1, 0);
+  g3.setStops(g1.stops());
+  QVERIFY(hasher(QBrush(g1)) != hasher(QBrush(g3)));
+}
+
+void HasherTest::textureBrush()
+{
+  QImage img(64, 64, QImage::Format_ARGB32_Premultiplied);
+  img.fill(Qt::red);
+
+  // copies share the same image, so hash is the same
+  QBrush b1(img);
+  QBrush b2 = b1;
+  QCOMPARE(hasher(b1), hasher(b2));
+  QCOMPARE(hasher(b1), hasher(QBrush(img)));
+
+  // modified image is a different texture
+  QImage other = img;
+  other.setPixel(0, 0, qRgb(0, 0, 255));
+  QVERIFY(hasher(b1) != hasher(QBrush(other)));
+}
+
+void HasherTest::pixmapBrush()
+{
+  QPixmap pxm(64, 64);
+  pxm.fill(Qt::red);
+
+  // pixmap is converted only once, copies share the converted image
+  QBrush b1(pxm);
+  const auto h = hasher(b1);
+  QBrush b2 = b1;
+  QCOMPARE(hasher(b1), h);
+  QCOMPARE(hasher(b2), h);
+
+  QPixmap other(64, 64);
+  other.fill(Qt::blue);
+  QVERIFY(hasher(b1) != hasher(QBrush(other)));
+}
+
+QTEST_MAIN(HasherTest)
+
+#include "test_hasher.moc"
@@ -22,6 +22,26 @@ public:
 };
 
 
+// resource with changeable cache key
+class KeyResource final : public Resource
+{
+public:
+  explicit KeyResource(size_t key) noexcept : _key(key) {}
+
+  QRectF rect() const noexcept override { return QRectF(0, 0, 4, 4); }
+  qreal advanceX() const noexcept override { return 4; }
+  qreal advanceY() const noexcept override { return 4; }
+
+  void draw(QPainter* p) override { Q_UNUSED(p); }
+
+  size_t cacheKey() const noexcept override { return _key; }
+  void setKey(size_t key) noexcept { _key = key; }
+
+private:
+  size_t _key;
+};
+
+
 template<typename L>
 requires std::is_base_of_v<LayoutItem, L>
 class UpdateCounter final : public L
@@ -96,6 +116,10 @@ private slots:
   void nestedLayouts();
   void itemsOwnership();
   void assignParent();
+  void skipCleanSubtrees();
+  void batchedInvalidation();
+  void orderSensitiveCacheKey();
+  void cachedCacheKey();
 
 private:
   std::shared_ptr<UpdateCounter<TestLayout>> _test_layout;
@@ -192,6 +216,111 @@ void LayoutTest::assignParent()
   QCOMPARE(item->parent().get(), _test_layout.get());
 }
 
+void LayoutTest::skipCleanSubtrees()
+{
+  // only invalidated items and their parents should be recalculated
+  auto l1 = std::make_shared<UpdateCounter<TestLayout>>(r.width());
+  auto l2 = std::make_shared<UpdateCounter<TestLayout>>(r.width());
+  for (int i = 0; i < 3; i++) {
+    l1->addItem(std::make_shared<TestItem>(r, r.width(), r.height()));
+    l2->addItem(std::make_shared<TestItem>(r, r.width(), r.height()));
+  }
+  _test_layout->addItem(l1);
+  _test_layout->addItem(l2);
+  _parent_layout->updateGeometry();
+  QCOMPARE(l1->geometryUpdateCount(), 1);
+  QCOMPARE(l2->geometryUpdateCount(), 1);
+  QCOMPARE(_test_layout->geometryUpdateCount(), 1);
+  QCOMPARE(_parent_layout->geometryUpdateCount(), 1);
+
+  LayoutItem::resetRecalculatedItemsCount();
+  l2->items()[2]->updateGeometry();
+  // item itself, l2, test layout, parent layout
+  QCOMPARE(LayoutItem::recalculatedItemsCount(), 4);
+  QCOMPARE(l1->geometryUpdateCount(), 1);
+  QCOMPARE(l2->geometryUpdateCount(), 2);
+  QCOMPARE(_test_layout->geometryUpdateCount(), 2);
+  QCOMPARE(_parent_layout->geometryUpdateCount(), 2);
+  QVERIFY(!_parent_layout->isGeometryDirty());
+}
+
+void LayoutTest::batchedInvalidation()
+{
+  // invalidation should not cause any recalculation
+  std::vector<std::shared_ptr<UpdateCounter<TestItem>>> items;
+  for (int i = 0; i < 5; i++) {
+    auto item = std::make_shared<UpdateCounter<TestItem>>(r, r.width(), r.height());
+    _test_layout->addItem(item);
+    items.push_back(std::move(item));
+  }
+  _parent_layout->updateGeometry();
+  QCOMPARE(_test_layout->geometryUpdateCount(), 1);
+
+  LayoutItem::resetRecalculatedItemsCount();
+  for (const auto& item : items) item->invalidateGeometry();
+  QVERIFY(_test_layout->isGeometryDirty());
+  QVERIFY(_parent_layout->isGeometryDirty());
+  QCOMPARE(_test_layout->geometryUpdateCount(), 1);
+  QCOMPARE(LayoutItem::recalculatedItemsCount(), 0);
+  // all changes are handled by the single update
+  _parent_layout->updateGeometry();
+  QCOMPARE(LayoutItem::recalculatedItemsCount(), items.size() + 2);
+  for (const auto& item : items) QCOMPARE(item->geometryUpdateCount(), 1);
+  QCOMPARE(_test_layout->geometryUpdateCount(), 2);
+  QCOMPARE(_parent_layout->geometryUpdateCount(), 2);
+}
+
+void LayoutTest::orderSensitiveCacheKey()
+{
+  auto layout_key = [](std::initializer_list<size_t> keys) {
+    auto l = std::make_shared<TestLayout>();
+    for (auto k : keys)
+      l->addItem(std::make_shared<LayoutItem>(std::make_shared<KeyResource>(k)));
+    l->updateGeometry();
+    return l->resource()->cacheKey();
+  };
+  // permutations and pairs of equal items must not collide
+  QCOMPARE_NE(layout_key({1, 2, 0, 2, 1}), layout_key({2, 1, 0, 1, 2}));
+  QCOMPARE_NE(layout_key({1, 1}), layout_key({2, 2}));
+  QCOMPARE_NE(layout_key({1, 2}), layout_key({1, 2, 0}));
+  QCOMPARE_EQ(layout_key({1, 2, 3}), layout_key({1, 2, 3}));
+
+  // positions matter too
+  auto l1 = std::make_shared<TestLayout>(4.0);
+  auto l2 = std::make_shared<TestLayout>(6.0);
+  for (auto& l : {l1, l2}) {
+    l->addItem(std::make_shared<LayoutItem>(std::make_shared<KeyResource>(1)));
+    l->addItem(std::make_shared<LayoutItem>(std::make_shared<KeyResource>(2)));
+    l->updateGeometry();
+  }
+  QCOMPARE_NE(l1->resource()->cacheKey(), l2->resource()->cacheKey());
+}
+
+void LayoutTest::cachedCacheKey()
+{
+  auto res = std::make_shared<KeyResource>(1);
+  auto item = std::make_shared<LayoutItem>(res);
+  _test_layout->addItem(item);
+  _test_layout->addItem(std::make_shared<LayoutItem>(std::make_shared<KeyResource>(2)));
+  _parent_layout->updateGeometry();
+  const auto key = _parent_layout->resource()->cacheKey();
+
+  // key is cached, content change must be reported explicitly
+  res->setKey(3);
+  QCOMPARE(_parent_layout->resource()->cacheKey(), key);
+  item->invalidateContent();
+  QCOMPARE_NE(_parent_layout->resource()->cacheKey(), key);
+
+  res->setKey(1);
+  item->invalidateContent();
+  QCOMPARE(_parent_layout->resource()->cacheKey(), key);
+
+  // geometry change invalidates it too
+  _test_layout->setSpacing(8.0);
+  _test_layout->updateGeometry();
+  QCOMPARE_NE(_parent_layout->resource()->cacheKey(), key);
+}
+
 QTEST_MAIN(LayoutTest)
 
 #include "test_layout.moc"
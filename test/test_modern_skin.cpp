@@ -0,0 +1,80 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Nick Korotysh <nick.korotysh@gmail.com>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <QTest>
+
+#include <QFile>
+#include <QImage>
+#include <QTemporaryDir>
+
+#include "display_list.hpp"
+#include "modern_skin.hpp"
+
+using namespace Qt::Literals::StringLiterals;
+
+class ModernSkinTest : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void separatorAnimation();
+};
+
+namespace {
+
+// image with a separator between two static images
+constexpr const char* separator_skin = R"({
+  "name": "test",
+  "resources": {
+    "img": "img.png"
+  },
+  "layout": [
+    { "type": "static", "resource": "img" },
+    { "type": "static", "resource": "img", "is_separator": true, "pos": { "x": 10 } },
+    { "type": "static", "resource": "img", "pos": { "x": 20 } }
+  ]
+})";
+
+bool createSkin(const QTemporaryDir& dir)
+{
+  QImage img(8, 8, QImage::Format_ARGB32_Premultiplied);
+  img.fill(Qt::red);
+  if (!img.save(dir.filePath(u"img.png"_s)))
+    return false;
+
+  QFile f(dir.filePath(u"skin.json"_s));
+  return f.open(QIODevice::WriteOnly) && f.write(separator_skin) > 0;
+}
+
+} // namespace
+
+void ModernSkinTest::separatorAnimation()
+{
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  QVERIFY(createSkin(dir));
+
+  ModernSkin skin{QDir(dir.path())};
+  const QDateTime dt(QDate(2024, 3, 1), QTime(12, 30, 56));
+  const auto res = skin.process(dt);
+  const auto visible = DisplayList::record(res);
+  QCOMPARE(visible.commands().size(), std::size_t(3));
+
+  // separator is hidden, only its area must be repainted
+  skin.animateSeparator();
+  QVERIFY(!visible.isRecordedFrom(res));
+  const auto hidden = DisplayList::record(skin.process(dt));
+  QCOMPARE(visible.diff(hidden), visible.commands()[1].bounds);
+
+  // and shown again, the same as the first frame
+  skin.animateSeparator();
+  const auto shown = DisplayList::record(skin.process(dt));
+  QVERIFY(!hidden.diff(shown).isEmpty());
+  QVERIFY(visible.diff(shown).isEmpty());
+}
+
+QTEST_MAIN(ModernSkinTest)
+#include "test_modern_skin.moc"